@@ -0,0 +1,150 @@
+#include "alloctracker.h"
+
+#ifdef MONKEYTYPER_ALLOC_TRACKING
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+namespace {
+    std::atomic<std::uint64_t> phaseCalls[AllocPhaseCount];
+    std::atomic<std::uint64_t> phaseBytes[AllocPhaseCount];
+    thread_local AllocPhase currentPhase = AllocOther;
+
+    const char *phaseNames[AllocPhaseCount] = {"other", "input", "update", "render", "display", "logic"};
+    const AllocPhase checkedPhases[] = {AllocUpdate, AllocRender, AllocLogic};
+    constexpr int warmupFrames = 120;
+    constexpr int reportedFrameLimit = 20;
+
+    // Only the render thread ends frames, and the summary is printed after it has joined.
+    std::uint64_t frameNumber = 0;
+    int warmupLeft = warmupFrames;
+    std::uint64_t steadyFrames = 0;
+    std::uint64_t allocatingFrames = 0;
+    AllocCounts steadyTotals;
+    bool strict = std::getenv("MONKEYTYPER_ALLOC_STRICT") != nullptr;
+    constexpr int strictExitCode = 3;
+
+    void count(std::size_t size) {
+        phaseCalls[currentPhase].fetch_add(1, std::memory_order_relaxed);
+        phaseBytes[currentPhase].fetch_add(size, std::memory_order_relaxed);
+    }
+
+    void printCounts(const AllocCounts &counts) {
+        for (AllocPhase phase : checkedPhases) {
+            std::cerr << ' ' << phaseNames[phase] << ' ' << counts.calls[phase] << " (" << counts.bytes[phase] << " B)";
+        }
+        std::cerr << std::endl;
+    }
+}
+
+void *operator new(std::size_t size) {
+    count(size);
+    if (void *memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    count(size);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t rounded = (size + align - 1) / align * align;
+    if (void *memory = std::aligned_alloc(align, rounded ? rounded : align)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+std::uint64_t AllocCounts::totalCalls() const {
+    std::uint64_t total = 0;
+    for (std::uint64_t phaseTotal : calls) {
+        total += phaseTotal;
+    }
+    return total;
+}
+
+AllocPhaseScope::AllocPhaseScope(AllocPhase phase) : previous(currentPhase) {
+    currentPhase = phase;
+}
+
+AllocPhaseScope::~AllocPhaseScope() {
+    currentPhase = previous;
+}
+
+void setAllocThreadPhase(AllocPhase phase) {
+    currentPhase = phase;
+}
+
+AllocCounts takeAllocCounts() {
+    AllocCounts counts;
+    for (int phase = 0; phase < AllocPhaseCount; ++phase) {
+        counts.calls[phase] = phaseCalls[phase].exchange(0, std::memory_order_relaxed);
+        counts.bytes[phase] = phaseBytes[phase].exchange(0, std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+void endAllocFrame(bool steady) {
+    endAllocFrame(takeAllocCounts(), steady);
+}
+
+void endAllocFrame(const AllocCounts &counts, bool steady) {
+    ++frameNumber;
+    if (!steady) {
+        warmupLeft = warmupFrames;
+        return;
+    }
+    if (warmupLeft > 0) {
+        --warmupLeft;
+        return;
+    }
+
+    ++steadyFrames;
+    std::uint64_t checkedCalls = 0;
+    for (AllocPhase phase : checkedPhases) {
+        checkedCalls += counts.calls[phase];
+        steadyTotals.calls[phase] += counts.calls[phase];
+        steadyTotals.bytes[phase] += counts.bytes[phase];
+    }
+    if (checkedCalls == 0) {
+        return;
+    }
+    if (++allocatingFrames <= reportedFrameLimit) {
+        std::cerr << "Steady frame " << frameNumber << " allocated:";
+        printCounts(counts);
+    }
+    if (strict) {
+        reportAllocSummary();
+        std::cerr << "Allocation tracking is strict; exiting." << std::endl;
+        std::_Exit(strictExitCode);
+    }
+}
+
+void setAllocStrict(bool enabled) {
+    strict = enabled;
+}
+
+void reportAllocSummary() {
+    std::cerr << "Allocation tracking: " << allocatingFrames << " of " << steadyFrames << " steady frames allocated; totals:";
+    printCounts(steadyTotals);
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PROJECT_ALLOCTRACKER_H
+#define PROJECT_ALLOCTRACKER_H
+
+// Heap allocation accounting. Build with -DMONKEYTYPER_ALLOC_TRACKING=ON to replace global new and delete
+// with versions that count calls and bytes against the phase the calling thread is in. The render loop closes
+// each frame with ALLOC_FRAME_END and reports any steady-state frame that touched the heap.
+// In strict mode, opted into with setAllocStrict() or by setting MONKEYTYPER_ALLOC_STRICT in the
+// environment, the first such frame also ends the process with exit code 3.
+// Without it the macros expand to nothing.
+#ifdef MONKEYTYPER_ALLOC_TRACKING
+
+#include <cstdint>
+
+enum AllocPhase { AllocOther, AllocInput, AllocUpdate, AllocRender, AllocDisplay, AllocLogic, AllocPhaseCount };
+
+struct AllocCounts {
+    std::uint64_t calls[AllocPhaseCount] = {};
+    std::uint64_t bytes[AllocPhaseCount] = {};
+
+    std::uint64_t totalCalls() const;
+};
+
+// Sets the phase for the rest of the scope and restores the previous one after it.
+class AllocPhaseScope {
+public:
+    explicit AllocPhaseScope(AllocPhase phase);
+    ~AllocPhaseScope();
+    AllocPhaseScope(const AllocPhaseScope &) = delete;
+    AllocPhaseScope &operator=(const AllocPhaseScope &) = delete;
+
+private:
+    AllocPhase previous;
+};
+
+void setAllocThreadPhase(AllocPhase phase);
+// Returns the counts since the previous call and starts new ones.
+AllocCounts takeAllocCounts();
+// Update, render and logic must not allocate in a steady frame. The first frames after a
+// non-steady one are a warm-up while buffers grow to size, and are not checked.
+void endAllocFrame(bool steady);
+// The same, for a caller that has already taken the frame's counts.
+void endAllocFrame(const AllocCounts &counts, bool steady);
+void setAllocStrict(bool strict);
+void reportAllocSummary();
+
+#define ALLOC_CONCAT_INNER(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+#define ALLOC_PHASE(phase) AllocPhaseScope ALLOC_CONCAT(allocPhase, __LINE__)(phase)
+#define ALLOC_THREAD(phase) setAllocThreadPhase(phase)
+#define ALLOC_FRAME_END(steady) endAllocFrame(steady)
+#define ALLOC_SUMMARY() reportAllocSummary()
+
+#else
+
+#define ALLOC_PHASE(phase) static_cast<void>(0)
+#define ALLOC_THREAD(phase) static_cast<void>(0)
+#define ALLOC_FRAME_END(steady) static_cast<void>(0)
+#define ALLOC_SUMMARY() static_cast<void>(0)
+
+#endif
+
+#endif
@@ -0,0 +1,53 @@
+#include "bot.h"
+#include "stringutil.h"
+#include <algorithm>
+
+Bot::Bot(const BotProfile &profile, std::uint32_t seed) : profile(profile), rng(seed) {}
+
+void Bot::think(const Simulation &simulation, float dt, std::vector<sf::Uint32> &keys) {
+    keyBudget += profile.wordsPerMinute * 5.0 / 60.0 * dt;
+
+    // Keys typed this step have not reached the simulation yet, so track them locally.
+    pending = simulation.getTypedWord();
+    while (keyBudget >= 1.0) {
+        sf::Uint32 key = nextKey(simulation, pending);
+        if (key == 0) {
+            keyBudget = std::min(keyBudget, 1.0);
+            break;
+        }
+        keyBudget -= 1.0;
+        keys.push_back(key);
+        if (key == '\b') {
+            pending.erase(pending.getSize() - 1);
+        } else if (key == '\n') {
+            break;
+        } else {
+            pending += key;
+        }
+    }
+}
+
+sf::Uint32 Bot::nextKey(const Simulation &simulation, const sf::String &typed) {
+    const Simulation::ActiveWord *target = nullptr;
+    for (const auto &word : simulation.getWords()) {
+        if (startsWith(simulation.getWordText(word.wordId), typed) && (!target || word.x > target->x)) {
+            target = &word;
+        }
+    }
+    if (!target) {
+        return typed.isEmpty() ? 0 : '\b';
+    }
+    const sf::String &targetText = simulation.getWordText(target->wordId);
+    if (targetText.getSize() == typed.getSize()) {
+        return '\n';
+    }
+
+    sf::Uint32 expected = targetText[typed.getSize()];
+    std::uniform_real_distribution<double> roll(0.0, 1.0);
+    if (roll(rng) < profile.errorRate) {
+        std::uniform_int_distribution<int> letter('a', 'z');
+        sf::Uint32 wrong = static_cast<sf::Uint32>(letter(rng));
+        return wrong == expected ? (expected == 'z' ? 'a' : expected + 1) : wrong;
+    }
+    return expected;
+}
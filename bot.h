@@ -0,0 +1,31 @@
+#ifndef PROJECT_BOT_H
+#define PROJECT_BOT_H
+
+#include <SFML/System/String.hpp>
+#include <random>
+#include "simulation.h"
+
+struct BotProfile {
+    double wordsPerMinute = 60;
+    double errorRate = 0.05;
+};
+
+// A simulated typist. It chases the word closest to the right edge at a steady typing speed,
+// mistypes with the given probability and backspaces over its mistakes.
+class Bot {
+public:
+    Bot(const BotProfile &profile, std::uint32_t seed);
+
+    // Returns the keystrokes due after dt seconds of play, appending them to keys.
+    void think(const Simulation &simulation, float dt, std::vector<sf::Uint32> &keys);
+
+private:
+    sf::Uint32 nextKey(const Simulation &simulation, const sf::String &typed);
+
+    BotProfile profile;
+    std::mt19937 rng;
+    double keyBudget = 0;
+    sf::String pending;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef PROJECT_BYTEORDER_H
+#define PROJECT_BYTEORDER_H
+
+#include <cstdint>
+#include <vector>
+
+// Little-endian integers, as the save file and the race protocol write them.
+// The readers expect the caller to have checked that the bytes are there.
+inline void put16(std::vector<std::uint8_t> &out, std::uint16_t value) {
+    out.push_back(static_cast<std::uint8_t>(value));
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+}
+
+inline void put32(std::vector<std::uint8_t> &out, std::uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<std::uint8_t>(value >> shift));
+    }
+}
+
+inline void put64(std::vector<std::uint8_t> &out, std::uint64_t value) {
+    put32(out, static_cast<std::uint32_t>(value));
+    put32(out, static_cast<std::uint32_t>(value >> 32));
+}
+
+inline std::uint16_t read16(const std::uint8_t *data) {
+    return static_cast<std::uint16_t>(data[0] | data[1] << 8);
+}
+
+inline std::uint32_t read32(const std::uint8_t *data) {
+    return static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8 |
+           static_cast<std::uint32_t>(data[2]) << 16 | static_cast<std::uint32_t>(data[3]) << 24;
+}
+
+#endif
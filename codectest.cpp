@@ -0,0 +1,279 @@
+#include "raceprotocol.h"
+#include "savegame.h"
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Round trips and hostile input for the two decoders that read untrusted bytes: saved games from disk and
+// race messages from the network. Every decode reads from a heap copy of exactly the bytes under test, so a
+// read past the end shows up under AddressSanitizer.
+namespace {
+    bool check(bool condition, const std::string &what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+        }
+        return condition;
+    }
+
+    class ExactBuffer {
+    public:
+        ExactBuffer(const std::uint8_t *data, std::size_t size) : bytes(size ? new std::uint8_t[size] : nullptr), size(size) {
+            if (size) {
+                std::memcpy(bytes.get(), data, size);
+            }
+        }
+
+        std::unique_ptr<std::uint8_t[]> bytes;
+        std::size_t size;
+    };
+
+    bool decodesSavedGame(const std::vector<std::uint8_t> &encoded, std::size_t size, SavedGame &game) {
+        ExactBuffer buffer(encoded.data(), size);
+        return decodeSavedGame(buffer.bytes.get(), buffer.size, game);
+    }
+
+    long decodesRaceMessage(const std::vector<std::uint8_t> &encoded, std::size_t size, RaceMessage &message) {
+        ExactBuffer buffer(encoded.data(), size);
+        return decodeRaceMessage(buffer.bytes.get(), buffer.size, message);
+    }
+
+    // The checksum encodeSavedGame appends, so a test can forge saves that pass it.
+    void resealSavedGame(std::vector<std::uint8_t> &bytes) {
+        std::uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i + 4 < bytes.size(); ++i) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        for (int i = 0; i < 4; ++i) {
+            bytes[bytes.size() - 4 + i] = static_cast<std::uint8_t>(hash >> (8 * i));
+        }
+    }
+
+    SavedGame sampleSavedGame() {
+        SavedGame game;
+        game.category = "Technology";
+        game.font = 2;
+        game.fontSize = 45;
+        Simulation::State &state = game.state;
+        state.config.width = 1200;
+        state.config.lives = 3;
+        state.schedule.seed = 1234;
+        state.schedule.draws = 5000000000ull;
+        state.schedule.timeElapsed = 0.75f;
+        state.schedule.wordCount = 42;
+        state.corpusHash = 0x0123456789abcdefull;
+        state.points = 17;
+        state.lives = 2;
+        state.typedWord = "comp";
+        state.streamedWords.push_back(sf::String("streamed"));
+        for (std::uint32_t i = 0; i < 5; ++i) {
+            Simulation::ActiveWord word;
+            word.wordId = i == 3 ? Simulation::streamedWordBit : i * 7;
+            word.typedLength = i % 2;
+            word.x = 10.5f * static_cast<float>(i);
+            word.y = 700 - static_cast<float>(i);
+            state.words.push_back(word);
+        }
+        return game;
+    }
+
+    bool savedGameRoundTrip() {
+        SavedGame original = sampleSavedGame();
+        std::vector<std::uint8_t> encoded;
+        encodeSavedGame(original, encoded);
+        SavedGame decoded;
+        if (!check(decodesSavedGame(encoded, encoded.size(), decoded), "saved game decodes")) {
+            return false;
+        }
+        const Simulation::State &a = original.state, &b = decoded.state;
+        bool ok = check(decoded.category == original.category && decoded.font == original.font &&
+                        decoded.fontSize == original.fontSize, "category and font survive");
+        ok &= check(a.config.width == b.config.width && a.config.lives == b.config.lives &&
+                    a.config.scheduledSpawns == b.config.scheduledSpawns, "config survives");
+        ok &= check(a.schedule.seed == b.schedule.seed && a.schedule.draws == b.schedule.draws &&
+                    a.schedule.timeElapsed == b.schedule.timeElapsed && a.schedule.wordCount == b.schedule.wordCount,
+                    "schedule survives");
+        ok &= check(a.corpusHash == b.corpusHash && a.points == b.points && a.lives == b.lives && a.over == b.over,
+                    "score survives");
+        ok &= check(a.typedWord == b.typedWord && a.streamedWords == b.streamedWords, "text survives");
+        ok &= check(a.words.size() == b.words.size(), "word count survives");
+        for (std::size_t i = 0; ok && i < a.words.size(); ++i) {
+            ok &= check(a.words[i].wordId == b.words[i].wordId && a.words[i].typedLength == b.words[i].typedLength &&
+                        a.words[i].x == b.words[i].x && a.words[i].y == b.words[i].y, "word " + std::to_string(i) + " survives");
+        }
+        std::vector<std::uint8_t> reencoded;
+        encodeSavedGame(decoded, reencoded);
+        return ok && check(reencoded == encoded, "re-encoding gives the same bytes");
+    }
+
+    bool savedGameTruncated() {
+        std::vector<std::uint8_t> encoded;
+        encodeSavedGame(sampleSavedGame(), encoded);
+        bool ok = true;
+        for (std::size_t size = 0; size < encoded.size(); ++size) {
+            SavedGame decoded;
+            ok &= check(!decodesSavedGame(encoded, size, decoded), "save cut to " + std::to_string(size) + " bytes is rejected");
+        }
+        return ok;
+    }
+
+    bool savedGameCorrupt() {
+        std::vector<std::uint8_t> encoded;
+        encodeSavedGame(sampleSavedGame(), encoded);
+        bool ok = true;
+        for (std::size_t i = 0; i < encoded.size(); ++i) {
+            std::vector<std::uint8_t> flipped = encoded;
+            flipped[i] ^= 0x5A;
+            SavedGame decoded;
+            ok &= check(!decodesSavedGame(flipped, flipped.size(), decoded), "save with byte " + std::to_string(i) + " flipped is rejected");
+        }
+
+        // Saves whose checksum is right but whose contents are not.
+        std::vector<std::uint8_t> newer = encoded;
+        newer[4] = 2;
+        resealSavedGame(newer);
+        SavedGame decoded;
+        ok &= check(!decodesSavedGame(newer, newer.size(), decoded), "save from another version is rejected");
+
+        std::vector<std::uint8_t> padded = encoded;
+        padded.insert(padded.end() - 4, 0);
+        resealSavedGame(padded);
+        ok &= check(!decodesSavedGame(padded, padded.size(), decoded), "save with trailing bytes is rejected");
+
+        // The on-screen word count sits just before the words: 5 words of 16 bytes and the checksum.
+        std::vector<std::uint8_t> overlong = encoded;
+        std::size_t countOffset = encoded.size() - 4 - 5 * 16 - 2;
+        overlong[countOffset] = 0xFF;
+        overlong[countOffset + 1] = 0xFF;
+        resealSavedGame(overlong);
+        ok &= check(!decodesSavedGame(overlong, overlong.size(), decoded), "save claiming more words than it holds is rejected");
+        return ok;
+    }
+
+    std::vector<RaceMessage> sampleRaceMessages() {
+        std::vector<RaceMessage> messages(7);
+        messages[0].type = RaceHello;
+        messages[1].type = RaceWelcome;
+        messages[1].score.playerId = 513;
+        messages[1].category = "Entertainment";
+        messages[2].type = RaceStart;
+        messages[2].seed = 0xdeadbeef;
+        messages[3].type = RaceSpawn;
+        messages[3].spawn.wordIndex = 70000;
+        messages[3].spawn.yFraction = 40000;
+        messages[4].type = RaceScore;
+        messages[4].score.points = 123456;
+        messages[4].score.lives = 4;
+        messages[5].type = RaceScores;
+        messages[5].score.playerId = 9;
+        messages[5].score.points = 77;
+        messages[5].score.lives = 1;
+        messages[6].type = RaceFinish;
+        return messages;
+    }
+
+    bool sameRaceMessage(const RaceMessage &a, const RaceMessage &b) {
+        if (a.type != b.type) {
+            return false;
+        }
+        switch (a.type) {
+            case RaceWelcome:
+                return a.score.playerId == b.score.playerId && a.category == b.category;
+            case RaceStart:
+                return a.seed == b.seed;
+            case RaceSpawn:
+                return a.spawn.wordIndex == b.spawn.wordIndex && a.spawn.yFraction == b.spawn.yFraction;
+            case RaceScore:
+                return a.score.points == b.score.points && a.score.lives == b.score.lives;
+            case RaceScores:
+                return a.score.playerId == b.score.playerId && a.score.points == b.score.points && a.score.lives == b.score.lives;
+            default:
+                return true;
+        }
+    }
+
+    bool raceMessageRoundTrip() {
+        std::vector<RaceMessage> messages = sampleRaceMessages();
+        std::vector<std::uint8_t> stream;
+        for (const auto &message : messages) {
+            encodeRaceMessage(message, stream);
+        }
+        ExactBuffer buffer(stream.data(), stream.size());
+        std::size_t offset = 0;
+        bool ok = true;
+        for (const auto &message : messages) {
+            RaceMessage decoded;
+            long used = decodeRaceMessage(buffer.bytes.get() + offset, buffer.size - offset, decoded);
+            std::string what = "message type " + std::to_string(message.type);
+            if (!check(used > 0, what + " decodes")) {
+                return false;
+            }
+            ok &= check(sameRaceMessage(message, decoded), what + " survives");
+            offset += static_cast<std::size_t>(used);
+        }
+        return ok && check(offset == stream.size(), "the stream is consumed exactly");
+    }
+
+    bool raceMessageTruncated() {
+        bool ok = true;
+        for (const auto &message : sampleRaceMessages()) {
+            std::vector<std::uint8_t> encoded;
+            encodeRaceMessage(message, encoded);
+            for (std::size_t size = 0; size < encoded.size(); ++size) {
+                RaceMessage decoded;
+                ok &= check(decodesRaceMessage(encoded, size, decoded) == 0, "message type " + std::to_string(message.type) +
+                            " cut to " + std::to_string(size) + " bytes waits for more");
+            }
+        }
+
+        // A Welcome whose category length runs past the bytes received.
+        std::vector<std::uint8_t> welcome = {RaceWelcome, 1, 0, 200, 'M', 'i', 'x'};
+        RaceMessage decoded;
+        ok &= check(decodesRaceMessage(welcome, welcome.size(), decoded) == 0, "welcome with a long category waits for more");
+        return ok;
+    }
+
+    bool raceMessageCorrupt() {
+        bool ok = true;
+        for (int type : {0, RaceFinish + 1, 0xFF}) {
+            std::vector<std::uint8_t> encoded = {static_cast<std::uint8_t>(type), 0, 0, 0, 0, 0, 0, 0};
+            RaceMessage decoded;
+            ok &= check(decodesRaceMessage(encoded, encoded.size(), decoded) < 0, "unknown type " + std::to_string(type) + " is malformed");
+        }
+        return ok;
+    }
+
+    const std::map<std::string, bool (*)()> cases = {
+        {"savegame_roundtrip", savedGameRoundTrip},
+        {"savegame_truncated", savedGameTruncated},
+        {"savegame_corrupt", savedGameCorrupt},
+        {"race_roundtrip", raceMessageRoundTrip},
+        {"race_truncated", raceMessageTruncated},
+        {"race_corrupt", raceMessageCorrupt},
+    };
+}
+
+// Usage: monkeytyper_codectest [case...]
+// Runs the named cases, or all of them, and exits with 1 if any failed.
+int main(int argc, char *argv[]) {
+    std::vector<std::string> selected(argv + 1, argv + argc);
+    if (selected.empty()) {
+        for (const auto &entry : cases) {
+            selected.push_back(entry.first);
+        }
+    }
+    bool passed = true;
+    for (const auto &name : selected) {
+        auto found = cases.find(name);
+        if (found == cases.end()) {
+            std::cerr << "Unknown case " << name << std::endl;
+            return 2;
+        }
+        bool ok = found->second();
+        std::cout << (ok ? "ok      " : "FAILED  ") << name << std::endl;
+        passed = passed && ok;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#include "corpus.h"
+#include "trace.h"
+#include <cctype>
+#include <fstream>
+#include <iostream>
+
+bool loadWordList(const std::string &filename, std::vector<sf::String> &words) {
+    TRACE_ZONE("loadWordList");
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return false;
+    }
+    std::string word;
+    while (file >> word) {
+        words.push_back(sf::String::fromUtf8(word.begin(), word.end()));
+    }
+    return true;
+}
+
+void parseWordList(const unsigned char *data, std::size_t size, std::vector<sf::String> &words) {
+    const unsigned char *end = data + size;
+    while (data != end) {
+        while (data != end && std::isspace(*data)) {
+            ++data;
+        }
+        const unsigned char *word = data;
+        while (data != end && !std::isspace(*data)) {
+            ++data;
+        }
+        if (word != data) {
+            words.push_back(sf::String::fromUtf8(word, data));
+        }
+    }
+}
+
+std::uint64_t hashWordList(const std::vector<sf::String> &words) {
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](std::uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            hash ^= (value >> shift) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+    for (const auto &word : words) {
+        for (sf::Uint32 c : word) {
+            mix(c);
+        }
+        mix(0);
+    }
+    return hash;
+}
+
+bool loadCorpus(const std::string &filename, Corpus &corpus) {
+    corpus.words.clear();
+    if (!loadWordList(filename, corpus.words)) {
+        return false;
+    }
+    corpus.index.build(corpus.words);
+    corpus.hash = hashWordList(corpus.words);
+    return true;
+}
+
+void loadCorpus(const unsigned char *data, std::size_t size, Corpus &corpus) {
+    corpus.words.clear();
+    parseWordList(data, size, corpus.words);
+    corpus.index.build(corpus.words);
+    corpus.hash = hashWordList(corpus.words);
+}
@@ -0,0 +1,31 @@
+#ifndef PROJECT_CORPUS_H
+#define PROJECT_CORPUS_H
+
+#include <SFML/System/String.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "wordindex.h"
+
+// Appends every whitespace-separated word in a UTF-8 file to words.
+bool loadWordList(const std::string &filename, std::vector<sf::String> &words);
+// The same for a word file that is already in memory.
+void parseWordList(const unsigned char *data, std::size_t size, std::vector<sf::String> &words);
+
+// FNV-1a over the words in order, so a recorded session can tell if its word list has changed.
+std::uint64_t hashWordList(const std::vector<sf::String> &words);
+
+// A loaded word list with its index. Once a game uses it, it is shared read-only between threads,
+// so a reload builds a new Corpus instead of changing this one.
+struct Corpus {
+    std::vector<sf::String> words;
+    WordIndex index;
+    std::uint64_t hash = 0;
+};
+
+// Loads words, builds the index and hashes the list. Widths are measured separately, once a font is known.
+bool loadCorpus(const std::string &filename, Corpus &corpus);
+void loadCorpus(const unsigned char *data, std::size_t size, Corpus &corpus);
+
+#endif
@@ -0,0 +1,18 @@
+# Writes OUTPUT, a C++ source holding each file in FILES (separated by |) as a byte array,
+# with a table that embeddedassets.cpp searches by file name.
+string(REPLACE "|" ";" FILES "${FILES}")
+set(source "// Generated by embedassets.cmake from the asset files. Do not edit.\n#include \"embeddedassets.h\"\n\n")
+set(table "")
+set(index 0)
+foreach (file IN LISTS FILES)
+    get_filename_component(name "${file}" NAME)
+    file(READ "${file}" hex HEX)
+    string(LENGTH "${hex}" length)
+    math(EXPR size "${length} / 2")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+    string(APPEND source "static constexpr unsigned char asset${index}[] = {${bytes}0};\n")
+    string(APPEND table "    {\"${name}\", asset${index}, ${size}},\n")
+    math(EXPR index "${index} + 1")
+endforeach ()
+string(APPEND source "\nextern const EmbeddedAsset embeddedAssets[] = {\n${table}};\nextern const std::size_t embeddedAssetCount = ${index};\n")
+file(WRITE "${OUTPUT}" "${source}")
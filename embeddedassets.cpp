@@ -0,0 +1,19 @@
+#include "embeddedassets.h"
+
+#ifdef MONKEYTYPER_EMBED_ASSETS
+extern const EmbeddedAsset embeddedAssets[];
+extern const std::size_t embeddedAssetCount;
+#endif
+
+const EmbeddedAsset *findEmbeddedAsset(const std::string &name) {
+#ifdef MONKEYTYPER_EMBED_ASSETS
+    for (std::size_t i = 0; i < embeddedAssetCount; ++i) {
+        if (name == embeddedAssets[i].name) {
+            return &embeddedAssets[i];
+        }
+    }
+#else
+    static_cast<void>(name);
+#endif
+    return nullptr;
+}
@@ -0,0 +1,17 @@
+#ifndef PROJECT_EMBEDDEDASSETS_H
+#define PROJECT_EMBEDDEDASSETS_H
+
+#include <cstddef>
+#include <string>
+
+// Asset files compiled into the binary when it is built with -DMONKEYTYPER_EMBED_ASSETS=ON.
+struct EmbeddedAsset {
+    const char *name;
+    const unsigned char *data;
+    std::size_t size;
+};
+
+// Returns the embedded copy of an asset by file name, or nullptr if it was not compiled in.
+const EmbeddedAsset *findEmbeddedAsset(const std::string &name);
+
+#endif
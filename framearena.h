@@ -0,0 +1,32 @@
+#ifndef PROJECT_FRAMEARENA_H
+#define PROJECT_FRAMEARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+
+// Memory for temporaries that live until the end of the frame, handed out to std::pmr containers.
+// Allocations bump a pointer through a fixed buffer and reset() rewinds it, so a per-frame list or
+// ranking costs no heap traffic. Only a frame that outgrows the buffer falls back to the heap.
+// Not thread-safe: each arena belongs to the thread that draws frames.
+class FrameArena {
+public:
+    FrameArena() = default;
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    std::pmr::memory_resource *resource() {
+        return &arena;
+    }
+
+    void reset() {
+        arena.release();
+    }
+
+    static constexpr std::size_t capacity = 16 * 1024;
+
+private:
+    alignas(std::max_align_t) std::byte buffer[capacity];
+    std::pmr::monotonic_buffer_resource arena{buffer, capacity, std::pmr::new_delete_resource()};
+};
+
+#endif
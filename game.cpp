@@ -1,50 +1,336 @@
-#include "Game.h"
+#include "game.h"
+#include "alloctracker.h"
+#include "trace.h"
 #include <iostream>
+#include <algorithm>
+#include <iterator>
 #include <string>
 #include <fstream>
 #include <ctime>
 #include <iomanip>
+#include <filesystem>
+#include <chrono>
+#include <sstream>
+#include <charconv>
+#include <memory_resource>
+#include <string_view>
+
+namespace {
+    const sf::String scoreLabel("Your Score: ");
+    const sf::String typedLabel("Typed Word: ");
+    const sf::String livesLabel("Lives: ");
+    constexpr int autosaveSteps = static_cast<int>(1 / Simulation::stepSeconds);
+
+    // Rasterizes each character at the given size so the first frame that draws it does not have to.
+    template <typename Characters>
+    void prewarm(const sf::Font &font, unsigned characterSize, const Characters &characters) {
+        for (sf::Uint32 c : characters) {
+            font.getGlyph(c, characterSize, false);
+        }
+    }
+
+    // sf::String has no reserve() or push_back(); appending one character at a time keeps to the
+    // capacity the string already has, where building a new string would allocate.
+    void appendAscii(sf::String &text, std::string_view ascii) {
+        for (char c : ascii) {
+            text += static_cast<sf::Uint32>(static_cast<unsigned char>(c));
+        }
+    }
+
+    void appendNumber(sf::String &text, int value) {
+        char digits[16];
+        std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        appendAscii(text, std::string_view(digits, result.ptr - digits));
+    }
+
+    void assignRange(sf::String &text, const sf::String &from, std::size_t begin, std::size_t end) {
+        text.clear();
+        for (std::size_t i = begin; i < end; ++i) {
+            text += from[i];
+        }
+    }
+}
 
-Game::Game(sf::RenderWindow &win) : window(win), color(sf::Color::White), fontSize(30), speed(100), points(0), wordCount(0), spawnInterval(2.5), timeElapsed(0), lives(1), gameStatus(Active), paused(false), chosenFont(0) {
+Game::Game(sf::RenderWindow &win, Resources &resources) : window(win), resources(resources), fontTNR(resources.fontTNR), fontBold(resources.fontBold), fontHorror(resources.fontHorror), fontRoboto(resources.fontRoboto), bgTexture(resources.background), gameFont(&resources.fontTNR), color(sf::Color::White), fontSize(30), points(0), lives(1), gameStatus(Active), chosenFont(0) {
     loadResources();
     setupLayout();
+    std::error_code error;
+    if (std::filesystem::is_directory("../assets", error)) {
+        wordWatcher.start("../assets");
+        savedGames.start(savedGameFile);
+    }
+}
+Game::~Game() {
+    stopSimulation();
+    suspend();
 }
 
-void Game::start() {
-    setCategory(currentCategory);
-    if (wordList.empty()) {
+void Game::enter() {
+    TRACE_ZONE("Game::enter");
+    // resume() has just loaded the saved game's word list.
+    if (!resuming) {
+        setCategory(currentCategory);
+    }
+    if (corpus->words.empty() && !wordStream.isOpen()) {
         std::cerr << "No words loaded from file." << std::endl;
+        closing = true;
         return;
     }
-    while (window.isOpen()) {
-        window.clear();
-        handleInput();
-        if (gameStatus == Active) {
-            updateGame();
+    setupLayout();
+    startSimulation();
+}
+void Game::update() {
+    TRACE_ZONE("Game::update");
+    std::string reloadedFile;
+    if (std::shared_ptr<Corpus> reloaded = wordWatcher.takeReloaded(reloadedFile)) {
+        adoptReloadedCorpus(std::move(reloaded), reloadedFile);
+    }
+    if (!snapshots.update()) {
+        return;
+    }
+    const Simulation::Snapshot &view = snapshots.front();
+    if (race.isConnected()) {
+        raceStandings = view.raceStandings;
+    }
+    points = view.points;
+    lives = view.lives;
+    if (typedWord != view.typedWord) {
+        typedWord = view.typedWord;
+    }
+    if (view.over && gameStatus == Active) {
+        std::cerr << "Game Over: No lives left." << std::endl;
+        stopSimulation();
+        gameStatus = Ended;
+        savedGames.discard();
+        saveResult();
+        saveSession();
+    }
+}
+
+void Game::startSimulation() {
+    TRACE_ZONE("Game::startSimulation");
+    stopSimulation();
+    sf::Uint32 staleChar;
+    while (typedChars.pop(staleChar)) {
+    }
+    {
+        std::lock_guard<std::mutex> lock(incomingMutex);
+        incomingCorpus.reset();
+        corpusIncoming = false;
+    }
+    // A reload from before the game would be swapped in right away and cancel the session recording.
+    wordWatcher.discardReloaded();
+    measureWords();
+    prewarmGlyphs();
+    primeTextBuffers();
+    simulation.setWordSource(corpus, &wordStream);
+    activeConfig = simulationConfig();
+    activeConfig.scheduledSpawns = !race.isConnected();
+    bool restored = false;
+    if (resuming) {
+        resuming = false;
+        restored = !race.isConnected() && simulation.restoreState(savedGame.state);
+        if (restored) {
+            activeConfig = savedGame.state.config;
+        } else {
+            std::cerr << "The saved game does not match the " << currentCategory << " word list; starting a new game." << std::endl;
+        }
+    }
+    unsigned seed = std::random_device{}();
+    if (!restored) {
+        simulation.reset(activeConfig, seed);
+    }
+    // A resumed game could not be replayed from its start, so it is not recorded.
+    if (!restored && !race.isConnected() && !wordStream.isOpen()) {
+        SessionHeader header;
+        header.seed = seed;
+        header.category = currentCategory;
+        header.corpusHash = corpus->hash;
+        header.config = activeConfig;
+        header.advances = corpus->index.getAdvances();
+        recorder.begin(header);
+    } else {
+        recorder.cancel();
+    }
+    autosaving = !race.isConnected();
+    // Saves rotate through savedGameBytes and the writer's two buffers, so all three get room for a full screen up front.
+    std::size_t saveCapacity = savedGameCapacity(Simulation::reservedWords);
+    savedGameBytes.reserve(saveCapacity);
+    savedGames.reserve(saveCapacity);
+    savedGame.category = currentCategory;
+    savedGame.font = resources.getFontChoice(*gameFont);
+    savedGame.fontSize = fontSize;
+    if (race.isConnected()) {
+        RaceMessage hello;
+        hello.type = RaceHello;
+        race.send(hello);
+    }
+    simulation.capture(snapshots.back());
+    snapshots.publish();
+
+    // A resumed game waits for the player to press resume.
+    simulationPaused = restored;
+    if (restored) {
+        gameStatus = Paused;
+    }
+    simulationRunning = true;
+    logicThread = std::thread(&Game::runSimulation, this);
+}
+void Game::stopSimulation() {
+    simulationRunning = false;
+    if (logicThread.joinable()) {
+        logicThread.join();
+    }
+}
+void Game::runSimulation() {
+    TRACE_THREAD("logic");
+    ALLOC_THREAD(AllocLogic);
+    sf::Clock clock;
+    bool racing = race.isConnected();
+    bool waitingForRace = racing;
+    int sentPoints = -1;
+    int sentLives = -1;
+    int stepsSinceSave = 0;
+    float accumulator = 0;
+    while (simulationRunning) {
+        if (race.isConnected()) {
+            pollRace(waitingForRace);
+        }
+        if (waitingForRace && !race.isConnected()) {
+            // The server went away before the race started, so the player gets a solo game instead.
+            std::cerr << "Lost the race server before the race started; playing solo." << std::endl;
+            activeConfig.scheduledSpawns = true;
+            simulation.reset(activeConfig, std::random_device{}());
+            waitingForRace = false;
+            racing = false;
+        } else if (racing && !race.isConnected() && !simulation.isOver()) {
+            // No more spawns can arrive, so the race ends here with the score the player has.
+            std::cerr << "Lost the race server; ending the race." << std::endl;
+            simulation.finish();
+        }
+        if (simulationPaused || waitingForRace) {
+            clock.restart();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
         }
-        render();
-        window.display();
+        // Fixed steps keep the game reproducible from its seed and the step each key landed on.
+        if (corpusIncoming.load(std::memory_order_acquire)) {
+            std::shared_ptr<const Corpus> reloaded;
+            {
+                std::lock_guard<std::mutex> lock(incomingMutex);
+                reloaded = std::move(incomingCorpus);
+                corpusIncoming = false;
+            }
+            // A replay could not reproduce the swap, so this game is no longer recorded.
+            simulation.swapCorpus(std::move(reloaded));
+            recorder.cancel();
+        }
+        accumulator += std::min(clock.restart().asSeconds(), 0.25f);
+        while (accumulator >= Simulation::stepSeconds && !simulation.isOver()) {
+            sf::Uint32 typedChar;
+            while (typedChars.pop(typedChar)) {
+                simulation.typeChar(typedChar);
+                recorder.recordKey(typedChar);
+            }
+            simulation.step(Simulation::stepSeconds);
+            recorder.recordStep();
+            accumulator -= Simulation::stepSeconds;
+            ++stepsSinceSave;
+        }
+        if (autosaving && stepsSinceSave >= autosaveSteps && !simulation.isOver()) {
+            saveGame();
+            stepsSinceSave = 0;
+        }
+
+        if (race.isConnected() && (simulation.getPoints() != sentPoints || simulation.getLives() != sentLives)) {
+            sentPoints = simulation.getPoints();
+            sentLives = simulation.getLives();
+            RaceMessage score;
+            score.type = RaceScore;
+            score.score.points = static_cast<std::uint32_t>(sentPoints);
+            score.score.lives = static_cast<std::uint8_t>(std::max(sentLives, 0));
+            race.send(score);
+        }
+
+        simulation.capture(snapshots.back());
+        snapshots.back().raceStandings = liveRaceStandings;
+        snapshots.publish();
+        if (simulation.isOver()) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 }
+// Runs on the logic thread. Nothing moves until the server starts the race with a shared seed.
+void Game::pollRace(bool &waitingForRace) {
+    RaceMessage message;
+    while (race.poll(message)) {
+        if (message.type == RaceStart) {
+            simulation.reset(activeConfig, message.seed);
+            liveRaceStandings.clear();
+            waitingForRace = false;
+        } else if (message.type == RaceSpawn && !waitingForRace) {
+            simulation.spawnFromServer(message.spawn);
+        } else if (message.type == RaceFinish && !waitingForRace) {
+            simulation.finish();
+        } else if (message.type == RaceScores) {
+            auto standing = std::find_if(liveRaceStandings.begin(), liveRaceStandings.end(),
+                                         [&message](const RaceStanding &entry) {
+                                             return entry.playerId == message.score.playerId;
+                                         });
+            if (standing != liveRaceStandings.end()) {
+                *standing = message.score;
+            } else {
+                liveRaceStandings.push_back(message.score);
+            }
+        }
+    }
+}
+bool Game::joinRace(const std::string &host, std::uint16_t port) {
+    if (!race.connect(host, port)) {
+        return false;
+    }
+    // Hello waits for startSimulation(), so the server does not count this player in until a game starts.
+    RaceMessage message;
+    if (!race.waitFor(RaceWelcome, message, 5000)) {
+        std::cerr << "Race server did not answer." << std::endl;
+        race.disconnect();
+        return false;
+    }
+    racePlayerId = message.score.playerId;
+    raceCategory = message.category;
+    setCategory(raceCategory);
+    return true;
+}
+// Words spawn just off the left edge, so only an average glyph width is needed to place them.
+Simulation::Config Game::simulationConfig() const {
+    Simulation::Config config;
+    sf::Vector2u windowSize = window.getSize();
+    config.width = static_cast<float>(windowSize.x);
+    config.height = static_cast<float>(windowSize.y);
+    sf::Text sample("abcdefghijklmnopqrstuvwxyz", *gameFont, fontSize);
+    config.charWidth = sample.getLocalBounds().width / 26.0f;
+    config.lineHeight = static_cast<float>(fontSize);
+    config.lives = lives;
+    return config;
+}
 
 void Game::loadResources() {
-    if (!gameFont.loadFromFile("../assets/TimesNewRoman.ttf") ||
-        !fontTNR.loadFromFile("../assets/TimesNewRoman.ttf") ||
-        !fontBold.loadFromFile("../assets/Bold.ttf") ||
-        !fontHorror.loadFromFile("../assets/Horror.ttf") ||
-        !fontRoboto.loadFromFile("../assets/Roboto.ttf") ||
-        !bgTexture.loadFromFile("../assets/forest.png")) {
-        std::cerr << "Failed to load resources." << std::endl;
-    }
+    TRACE_ZONE("Game::loadResources");
     bgImage.setTexture(bgTexture);
 }
 void Game::setupLayout() {
+    TRACE_ZONE("Game::setupLayout");
     sf::Vector2u winSize = window.getSize();
     sf::Vector2u texSize = bgTexture.getSize();
     float scaleX = static_cast<float>(winSize.x) / texSize.x;
     float scaleY = static_cast<float>(winSize.y) / texSize.y;
     bgImage.setScale(scaleX, scaleY);
 
+    for (auto &layer : layers) {
+        layer.resize(winSize);
+    }
+    markLayersDirty();
     updateElementPositions();
 }
 void Game::updateElementPositions() {
@@ -68,99 +354,315 @@ void Game::updateElementPositions() {
 }
 
 void Game::uploadWordsFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (file.is_open()) {
-        std::string word;
-        while (file >> word) {
-            wordList.push_back(word);
-        }
-        file.close();
-    } else {
-        std::cerr << "Failed to open file: " << filename << std::endl;
-    }
-
-    if (wordList.empty()) {
+    TRACE_ZONE("Game::uploadWordsFromFile");
+    loadCorpus(filename, *corpus);
+    if (corpus->words.empty()) {
         std::cerr << "No words loaded from file " << filename << std::endl;
     }
 }
 void Game::setCategory(const std::string &category) {
+    TRACE_ZONE("Game::setCategory");
+    if (!raceCategory.empty() && category != raceCategory) {
+        return;
+    }
     currentCategory = category;
     categoryFilePath = "../assets/" + category + ".txt";
-    uploadWordsFromFile(categoryFilePath);
+    corpus = std::make_shared<Corpus>();
+    // The list is read fresh below, so a reload queued while another scene was showing is stale.
+    wordWatcher.discardReloaded();
+
+    const EmbeddedAsset *embedded = findEmbeddedAsset(category + ".txt");
+    std::error_code error;
+    std::uintmax_t fileSize = embedded ? 0 : std::filesystem::file_size(categoryFilePath, error);
+    if (!error && fileSize > WordStream::streamingThreshold) {
+        wordStream.open(categoryFilePath);
+        wordWatcher.setFile("");
+    } else {
+        wordStream.close();
+        if (embedded) {
+            loadCorpus(embedded->data, embedded->size, *corpus);
+        } else {
+            uploadWordsFromFile(categoryFilePath);
+        }
+        // An edited file on disk still replaces an embedded list. Race clients must keep the word list the server counted.
+        wordWatcher.setFile(raceCategory.empty() ? category + ".txt" : "");
+    }
+    measuredFont = nullptr;
+    warmedFont = nullptr;
+}
+// Widths are only re-measured when the font or size has changed since the last game.
+// Besides the corpus characters, the table covers everything the player can type, so a reloaded
+// word list that only adds words from the same alphabet can be measured with it off the render thread.
+void Game::measureWords() {
+    TRACE_ZONE("Game::measureWords");
+    if (corpus->index.isEmpty() || (measuredFont == gameFont && measuredSize == fontSize)) {
+        return;
+    }
+    std::vector<sf::Uint32> characters = corpus->index.getCharacters();
+    for (sf::Uint32 c = 32; c < 127; ++c) {
+        characters.push_back(c);
+    }
+    std::sort(characters.begin(), characters.end());
+    characters.erase(std::unique(characters.begin(), characters.end()), characters.end());
+    std::vector<WordIndex::Advance> advances;
+    advances.reserve(characters.size());
+    for (sf::Uint32 c : characters) {
+        advances.emplace_back(c, gameFont->getGlyph(c, fontSize, false).advance);
+    }
+    corpus->index.measure(corpus->words, advances);
+    wordWatcher.setAdvances(std::move(advances));
+    measuredFont = gameFont;
+    measuredSize = fontSize;
+}
+void Game::adoptReloadedCorpus(std::shared_ptr<Corpus> reloaded, const std::string &file) {
+    TRACE_ZONE("Game::adoptReloadedCorpus");
+    if (file != currentCategory + ".txt" || wordStream.isOpen() || !raceCategory.empty()) {
+        return;
+    }
+    std::cout << "Reloaded " << categoryFilePath << " (" << reloaded->words.size() << " words)" << std::endl;
+    std::shared_ptr<Corpus> previous = std::move(corpus);
+    corpus = std::move(reloaded);
+
+    // The watcher measured the list with the current font's advances, so only characters the old list did not
+    // have need glyphs. One missing from the advances too leaves its words short, so the next game re-measures.
+    const std::vector<sf::Uint32> &oldCharacters = previous->index.getCharacters();
+    const std::vector<sf::Uint32> &newCharacters = corpus->index.getCharacters();
+    std::vector<sf::Uint32> added;
+    std::set_difference(newCharacters.begin(), newCharacters.end(), oldCharacters.begin(), oldCharacters.end(),
+                        std::back_inserter(added));
+    const std::vector<WordIndex::Advance> &advances = corpus->index.getAdvances();
+    bool measured = measuredFont && corpus->index.isMeasured() && advances == previous->index.getAdvances() &&
+                    std::all_of(added.begin(), added.end(), [&advances](sf::Uint32 c) {
+                        return std::binary_search(advances.begin(), advances.end(), WordIndex::Advance(c, 0.0f),
+                                                  [](const WordIndex::Advance &a, const WordIndex::Advance &b) { return a.first < b.first; });
+                    });
+    if (!measured) {
+        measuredFont = nullptr;
+    }
+    if (warmedFont == gameFont && warmedSize == fontSize) {
+        prewarm(*gameFont, fontSize, added);
+        prewarm(*gameFont, scoreText.getCharacterSize(), added);
+    }
+    if (simulationRunning) {
+        std::lock_guard<std::mutex> lock(incomingMutex);
+        incomingCorpus = corpus;
+        corpusIncoming = true;
+    }
+}
+// SFML rasterizes glyphs the first time they are drawn at a size. Doing it for the corpus, everything the player
+// can type and the HUD before the game starts keeps the texture uploads out of game frames.
+void Game::prewarmGlyphs() {
+    TRACE_ZONE("Game::prewarmGlyphs");
+    if (warmedFont == gameFont && warmedSize == fontSize) {
+        return;
+    }
+    sf::String typeable;
+    for (sf::Uint32 c = 32; c < 127; ++c) {
+        typeable += c;
+    }
+    prewarm(*gameFont, fontSize, corpus->index.getCharacters());
+    prewarm(*gameFont, fontSize, typeable);
+    prewarm(*gameFont, scoreText.getCharacterSize(), typeable);
+    prewarm(*gameFont, 20, typeable);
+    prewarm(*gameFont, 24, sf::String("Results"));
+    prewarm(*gameFont, 40, sf::String("RESUME EXIT RESTART"));
+    warmedFont = gameFont;
+    warmedSize = fontSize;
+}
+
+// Strings and vertex arrays only grow, so sizing them once for the longest text a game shows
+// keeps the first long word or score from allocating in the middle of a game.
+void Game::primeTextBuffers() {
+    TRACE_ZONE("Game::primeTextBuffers");
+    sf::String longest;
+    for (std::size_t i = 0; i < 2 * WordIndex::maxLength; ++i) {
+        longest += static_cast<sf::Uint32>('W');
+    }
+    wordScratch = longest;
+    hudScratch = longest;
+    for (sf::String *text : {&typedWord, &shownTyped}) {
+        sf::String kept = *text;
+        *text = longest;
+        *text = kept;
+    }
+    for (sf::Text *text : {&wordText, &highlightedText, &remainingText, &scoreText, &typedText, &livesText, &raceText}) {
+        sf::String shown = text->getString();
+        if (text->getFont() == nullptr) {
+            text->setFont(*gameFont);
+        }
+        text->setString(longest);
+        text->getLocalBounds();
+        text->setString(shown);
+    }
 }
 void Game::changeFont(const sf::Font &newFont) {
-    gameFont = newFont;
+    gameFont = &newFont;
     for (auto& text : textItems) {
-        text.setFont(gameFont);
+        text.setFont(*gameFont);
     }
+    markLayersDirty();
 }
 void Game::changeFontSize(int newSize) {
     fontSize = newSize;
     for (auto& text : textItems) {
         text.setCharacterSize(fontSize);
     }
+    markLayersDirty();
 }
 int Game::getFontSize() const {
     return fontSize;
 }
 
+// Streamed words are decoded and interned as they spawn, so only games on an in-memory word list run without allocating.
+bool Game::isSteady() const {
+    return gameStatus == Active && simulationRunning && !simulationPaused && !wordStream.isOpen();
+}
+
 void Game::render() {
-    window.draw(bgImage);
+    TRACE_ZONE("Game::render");
+    frameArena.reset();
+    redrawLayers();
+    layers[BackgroundLayer].draw(window);
 
     if (gameStatus == Active) {
         displayWords();
-        displayScorePanel();
-        displayPauseBtn();
     }
-    if (gameStatus == Paused) {
-        displayResumeBtn();
-        displayExitBtn();
-        displayScorePanel();
+    if (gameStatus == Active || gameStatus == Paused) {
+        layers[HudLayer].draw(window);
+        if (race.isConnected()) {
+            displayRaceStandings();
+        }
+    }
+    layers[OverlayLayer].draw(window);
+}
+void Game::displayRaceStandings() {
+    TRACE_ZONE("Game::displayRaceStandings");
+    raceText.setFont(*gameFont);
+    raceText.setCharacterSize(20);
+    raceText.setFillColor(color);
+    // Leaders first. The ranking only lives for this frame, so it comes from the frame arena.
+    std::pmr::vector<const RaceStanding *> ranking(frameArena.resource());
+    ranking.reserve(raceStandings.size());
+    for (const auto &standing : raceStandings) {
+        ranking.push_back(&standing);
+    }
+    std::sort(ranking.begin(), ranking.end(), [](const RaceStanding *a, const RaceStanding *b) {
+        return a->points != b->points ? a->points > b->points : a->playerId < b->playerId;
+    });
+    float y = 10;
+    for (const RaceStanding *standing : ranking) {
+        hudScratch.clear();
+        appendAscii(hudScratch, "Player ");
+        appendNumber(hudScratch, standing->playerId);
+        appendAscii(hudScratch, ": ");
+        appendNumber(hudScratch, static_cast<int>(standing->points));
+        if (standing->lives == 0) {
+            appendAscii(hudScratch, " (out)");
+        }
+        if (standing->playerId == racePlayerId) {
+            appendAscii(hudScratch, " (you)");
+        }
+        raceText.setString(hudScratch);
+        raceText.setPosition(10, y);
+        window.draw(raceText);
+        y += 24;
+    }
+}
+void Game::redrawLayers() {
+    TRACE_ZONE("Game::redrawLayers");
+    if (layers[BackgroundLayer].isDirty()) {
+        layers[BackgroundLayer].beginRedraw().draw(bgImage);
+        layers[BackgroundLayer].endRedraw();
     }
 
-    if (gameStatus == Ended) {
-        displayGameOver();
-        displayExitBtn();
-        displayRestartBtn();
-        displayResultsBtn();
+    if (points != shownPoints || lives != shownLives || typedWord != shownTyped) {
+        layers[HudLayer].markDirty();
+    }
+    if ((gameStatus == Active || gameStatus == Paused) && layers[HudLayer].isDirty()) {
+        displayScorePanel(layers[HudLayer].beginRedraw());
+        layers[HudLayer].endRedraw();
     }
 
-    if (gameStatus == RestartMenu) {
-        displayRestartMenu();
-        displayExitBtn();
-        displayResultsBtn();
+    if (gameStatus != overlayState) {
+        overlayState = gameStatus;
+        layers[OverlayLayer].markDirty();
+    }
+    if (layers[OverlayLayer].isDirty()) {
+        sf::RenderTarget &target = layers[OverlayLayer].beginRedraw();
+        if (gameStatus == Active) {
+            displayPauseBtn(target);
+        }
+        if (gameStatus == Paused) {
+            displayResumeBtn(target);
+            displayExitBtn(target);
+        }
+        if (gameStatus == Ended) {
+            displayGameOver(target);
+            displayExitBtn(target);
+            displayRestartBtn(target);
+            displayResultsBtn(target);
+        }
+        if (gameStatus == RestartMenu) {
+            displayRestartMenu(target);
+            displayExitBtn(target);
+            displayResultsBtn(target);
+        }
+        layers[OverlayLayer].endRedraw();
     }
 }
-void Game::displayScorePanel() {
-    window.draw(scoreBg);
+void Game::markLayersDirty() {
+    for (auto &layer : layers) {
+        layer.markDirty();
+    }
+}
+void Game::displayScorePanel(sf::RenderTarget &target) {
+    TRACE_ZONE("Game::displayScorePanel");
+    target.draw(scoreBg);
 
-    scoreText.setFont(gameFont);
+    scoreText.setFont(*gameFont);
     scoreText.setFillColor(sf::Color::Black);
-    scoreText.setString("Your Score: " + std::to_string(points));
-    window.draw(scoreText);
+    if (points != shownPoints) {
+        shownPoints = points;
+        hudScratch = scoreLabel;
+        appendNumber(hudScratch, points);
+        scoreText.setString(hudScratch);
+    }
+    target.draw(scoreText);
 
-    typedText.setFont(gameFont);
+    typedText.setFont(*gameFont);
     typedText.setFillColor(sf::Color::Black);
-    typedText.setString("Typed Word: " + typedWord);
-    window.draw(typedText);
+    if (typedWord != shownTyped) {
+        shownTyped = typedWord;
+        hudScratch = typedLabel;
+        hudScratch += typedWord;
+        typedText.setString(hudScratch);
+    }
+    target.draw(typedText);
 
-    livesText.setFont(gameFont);
+    livesText.setFont(*gameFont);
     livesText.setFillColor(sf::Color::Black);
-    livesText.setString("Lives: " + std::to_string(lives));
-    window.draw(livesText);
+    if (lives != shownLives) {
+        shownLives = lives;
+        hudScratch = livesLabel;
+        appendNumber(hudScratch, lives);
+        livesText.setString(hudScratch);
+    }
+    target.draw(livesText);
 }
-void Game::displayGameOver() {
+void Game::displayGameOver(sf::RenderTarget &target) {
+    TRACE_ZONE("Game::displayGameOver");
     sf::Text gameOverText;
-    gameOverText.setFont(gameFont);
+    gameOverText.setFont(*gameFont);
     gameOverText.setCharacterSize(fontSize);
     gameOverText.setFillColor(sf::Color::Red);
     gameOverText.setString("Game Over. Your final score: " + std::to_string(points));
-    gameOverText.setPosition(window.getSize().x / 2 - gameOverText.getLocalBounds().width / 2, window.getSize().y / 2 - gameOverText.getLocalBounds().height / 2);
-    window.draw(gameOverText);
+    gameOverText.setPosition(target.getSize().x / 2 - gameOverText.getLocalBounds().width / 2, target.getSize().y / 2 - gameOverText.getLocalBounds().height / 2);
+    target.draw(gameOverText);
 }
-void Game::displayPauseBtn() {
+void Game::displayPauseBtn(sf::RenderTarget &target) {
+    TRACE_ZONE("Game::displayPauseBtn");
     pauseBtn.setSize(sf::Vector2f(20, 20));
-    pauseBtnText.setFont(gameFont);
+    pauseBtnText.setFont(*gameFont);
     pauseBtnText.setCharacterSize(20);
     pauseBtnText.setFillColor(sf::Color::Black);
     pauseBtnText.setString("||");
@@ -171,14 +673,15 @@ void Game::displayPauseBtn() {
     float textY = buttonBounds.top + (buttonBounds.height - textBounds.height) / 2 - textBounds.top;
     pauseBtnText.setPosition(textX, textY);
 
-    window.draw(pauseBtn);
-    window.draw(pauseBtnText);
+    target.draw(pauseBtn);
+    target.draw(pauseBtnText);
 }
-void Game::displayResumeBtn() {
+void Game::displayResumeBtn(sf::RenderTarget &target) {
+    TRACE_ZONE("Game::displayResumeBtn");
     resumeBtn.setSize(sf::Vector2f(200, 50));
     resumeBtn.setFillColor(sf::Color::Black);
 
-    resumeBtnText.setFont(gameFont);
+    resumeBtnText.setFont(*gameFont);
     resumeBtnText.setCharacterSize(40);
     resumeBtnText.setFillColor(sf::Color::White);
     resumeBtnText.setString("RESUME");
@@ -189,14 +692,15 @@ void Game::displayResumeBtn() {
     float textY = buttonBounds.top + (buttonBounds.height - textBounds.height) / 2 - textBounds.top;
     resumeBtnText.setPosition(textX, textY);
 
-    window.draw(resumeBtn);
-    window.draw(resumeBtnText);
+    target.draw(resumeBtn);
+    target.draw(resumeBtnText);
 }
-void Game::displayExitBtn() {
+void Game::displayExitBtn(sf::RenderTarget &target) {
+    TRACE_ZONE("Game::displayExitBtn");
     exitBtn.setSize(sf::Vector2f(200, 50));
     exitBtn.setFillColor(sf::Color::Black);
 
-    exitBtnText.setFont(gameFont);
+    exitBtnText.setFont(*gameFont);
     exitBtnText.setCharacterSize(40);
     exitBtnText.setFillColor(sf::Color::White);
     exitBtnText.setString("EXIT");
@@ -207,14 +711,15 @@ void Game::displayExitBtn() {
     float textY = buttonBounds.top + (buttonBounds.height - textBounds.height) / 2 - textBounds.top;
     exitBtnText.setPosition(textX, textY);
 
-    window.draw(exitBtn);
-    window.draw(exitBtnText);
+    target.draw(exitBtn);
+    target.draw(exitBtnText);
 }
-void Game::displayRestartBtn() {
+void Game::displayRestartBtn(sf::RenderTarget &target) {
+    TRACE_ZONE("Game::displayRestartBtn");
     restartBtn.setSize(sf::Vector2f(200, 50));
     restartBtn.setFillColor(sf::Color::Black);
 
-    restartBtnText.setFont(gameFont);
+    restartBtnText.setFont(*gameFont);
     restartBtnText.setCharacterSize(40);
     restartBtnText.setFillColor(sf::Color::White);
     restartBtnText.setString("RESTART");
@@ -225,42 +730,59 @@ void Game::displayRestartBtn() {
     float textY = buttonBounds.top + (buttonBounds.height - textBounds.height) / 2 - textBounds.top;
     restartBtnText.setPosition(textX, textY);
 
-    window.draw(restartBtn);
-    window.draw(restartBtnText);
+    target.draw(restartBtn);
+    target.draw(restartBtnText);
 }
-void Game::displayResultsBtn() {
+void Game::displayResultsBtn(sf::RenderTarget &target) {
+    TRACE_ZONE("Game::displayResultsBtn");
     resultsBtn.setSize(sf::Vector2f(200, 50));
     resultsBtn.setFillColor(sf::Color::Black);
 
-    resultsText.setFont(gameFont);
+    resultsText.setFont(*gameFont);
     resultsText.setString("Results");
     resultsText.setFillColor(sf::Color::White);
     resultsText.setCharacterSize(24);
     resultsText.setPosition(resultsBtn.getPosition().x + resultsBtn.getSize().x / 2.0f - resultsText.getLocalBounds().width / 2.0f, resultsBtn.getPosition().y + 10);
 
-    window.draw(resultsBtn);
-    window.draw(resultsText);
+    target.draw(resultsBtn);
+    target.draw(resultsText);
 }
 void Game::displayWords() {
-    for (const auto& word : wordsOnScreen) {
-        if (!word.typedPart.empty()) {
-            sf::Text highlightedText = word.text;
-            highlightedText.setString(word.typedPart);
+    TRACE_ZONE("Game::displayWords");
+    wordText.setFont(*gameFont);
+    wordText.setCharacterSize(fontSize);
+    wordText.setFillColor(color);
+    const Simulation::Snapshot &view = snapshots.front();
+    for (const auto& word : view.words) {
+        const sf::String &fullWord = view.getWordText(word);
+        wordText.setPosition(word.x, word.y);
+        if (word.typedLength > 0) {
+            std::size_t typedLength = std::min<std::size_t>(word.typedLength, fullWord.getSize());
+            highlightedText.setFont(*gameFont);
+            highlightedText.setCharacterSize(fontSize);
             highlightedText.setFillColor(sf::Color(211, 211, 211));
-
-            sf::Text remainingText = word.text;
-            remainingText.setString(word.fullWord.substr(word.typedPart.length()));
+            highlightedText.setPosition(word.x, word.y);
+            assignRange(wordScratch, fullWord, 0, typedLength);
+            highlightedText.setString(wordScratch);
+
+            remainingText.setFont(*gameFont);
+            remainingText.setCharacterSize(fontSize);
+            remainingText.setFillColor(color);
+            assignRange(wordScratch, fullWord, typedLength, fullWord.getSize());
+            remainingText.setString(wordScratch);
             float offsetX = highlightedText.getLocalBounds().width;
-            remainingText.setPosition(word.text.getPosition().x + offsetX, word.text.getPosition().y);
+            remainingText.setPosition(word.x + offsetX, word.y);
 
             window.draw(highlightedText);
             window.draw(remainingText);
         } else {
-            window.draw(word.text);
+            wordText.setString(fullWord);
+            window.draw(wordText);
         }
     }
 }
-void Game::displayRestartMenu() {
+void Game::displayRestartMenu(sf::RenderTarget &target) {
+    TRACE_ZONE("Game::displayRestartMenu");
     const float buttonSpacing = 25.0f;
     float yPos = 100 + buttonSpacing * 2;
 
@@ -336,22 +858,22 @@ void Game::displayRestartMenu() {
     currentFontSizeText.setString(std::to_string(getFontSize()));
     currentFontSizeText.setPosition(decreaseButton.getPosition().x + 25, yPos);
 
-    window.draw(titleText);
-    window.draw(TNRButton);
-    window.draw(TNRText);
-    window.draw(robotoButton);
-    window.draw(robotoText);
-    window.draw(HorrorButton);
-    window.draw(horrorText);
-    window.draw(boldButton);
-    window.draw(boldText);
-
-    window.draw(chooseSizeOfFontText);
-    window.draw(increaseButton);
-    window.draw(increaseSizeButtonText);
-    window.draw(decreaseButton);
-    window.draw(decreaseSizeButtonText);
-    window.draw(currentFontSizeText);
+    target.draw(titleText);
+    target.draw(TNRButton);
+    target.draw(TNRText);
+    target.draw(robotoButton);
+    target.draw(robotoText);
+    target.draw(HorrorButton);
+    target.draw(horrorText);
+    target.draw(boldButton);
+    target.draw(boldText);
+
+    target.draw(chooseSizeOfFontText);
+    target.draw(increaseButton);
+    target.draw(increaseSizeButtonText);
+    target.draw(decreaseButton);
+    target.draw(decreaseSizeButtonText);
+    target.draw(currentFontSizeText);
 
     TopicMenu.setSize(sf::Vector2f(200, 50));
     TopicMenu.setFillColor(sf::Color(255, 255, 255, 0));
@@ -376,23 +898,23 @@ void Game::displayRestartMenu() {
         TopicMenuOptions.push_back(option);
     }
 
-    window.draw(TopicMenu);
-    window.draw(TopicMenuText);
+    target.draw(TopicMenu);
+    target.draw(TopicMenuText);
 
     for (const auto &option : TopicMenuOptions) {
-        window.draw(option);
+        target.draw(option);
     }
 
     confirmBtn.setSize(sf::Vector2f(200, 50));
     confirmBtn.setFillColor(sf::Color::Black);
     confirmBtn.setPosition(restartBtn.getPosition().x, restartBtn.getPosition().y);
-    window.draw(confirmBtn);
+    target.draw(confirmBtn);
 
     confirmBtnText.setString("CONFIRM");
-    confirmBtnText.setFont(gameFont);
+    confirmBtnText.setFont(*gameFont);
     confirmBtnText.setFillColor(sf::Color::White);
     confirmBtnText.setPosition(confirmBtn.getPosition().x + (confirmBtn.getSize().x - confirmBtnText.getLocalBounds().width) / 2, confirmBtn.getPosition().y + (confirmBtn.getSize().y - confirmBtnText.getLocalBounds().height) / 2 - confirmBtnText.getLocalBounds().top);
-    window.draw(confirmBtnText);
+    target.draw(confirmBtnText);
 }
 void Game::updateChosenFontColor(int selectedFont) {
     TNRText.setFillColor(selectedFont == 0 ? sf::Color::Black : sf::Color::White);
@@ -405,20 +927,24 @@ void Game::handleMouseClick(sf::Vector2f mousePos) {
     if (gameStatus == Active || gameStatus == Paused) {
         if (pauseBtn.getGlobalBounds().contains(mousePos)) {
             gameStatus = Paused;
-            paused = true;
-            pausedTime = gameClock.getElapsedTime();
+            simulationPaused = true;
         } else if (resumeBtnText.getGlobalBounds().contains(mousePos)) {
             gameStatus = Active;
-            paused = false;
-            gameClock.restart();
-            timeElapsed -= pausedTime.asSeconds();
+            simulationPaused = false;
         } else if (exitBtn.getGlobalBounds().contains(mousePos)) {
-            saveResult();
-            window.close();
+            stopSimulation();
+            points = simulation.getPoints();
+            // A suspended game has no result yet; it is saved when the resumed game ends.
+            if (!suspend()) {
+                saveResult();
+            }
+            saveSession();
+            closing = true;
         } else if (restartBtn.getGlobalBounds().contains(mousePos)) {
             reset();
         }
     } else if (gameStatus == RestartMenu) {
+        layers[OverlayLayer].markDirty();
         if (TNRButton.getGlobalBounds().contains(mousePos)) {
             changeFont(fontTNR);
             chosenFont = 0;
@@ -450,175 +976,77 @@ void Game::handleMouseClick(sf::Vector2f mousePos) {
             }
         }
         if (exitBtn.getGlobalBounds().contains(mousePos)) {
-            window.close();
+            closing = true;
         }
         if (confirmBtn.getGlobalBounds().contains(mousePos)) {
-            changeFont(gameFont);
+            changeFont(*gameFont);
             changeFontSize(fontSize);
-            setCategory(currentCategory);
             points = 0;
-            wordCount = 0;
-            timeElapsed = 0;
-            speed = 100;
             lives = 5;
-
-            wordsOnScreen.clear();
             typedWord.clear();
             gameStatus = Active;
 
-            wordList.clear();
             setCategory(currentCategory);
-
-            gameClock.restart();
+            startSimulation();
         }
     }
 }
 void Game::handleGameOverScreenMouseClick(sf::Vector2f mousePos) {
     if (exitBtn.getGlobalBounds().contains(mousePos)) {
-        window.close();
+        closing = true;
     } else if (restartBtn.getGlobalBounds().contains(mousePos)) {
         reset();
     } else if (resultsBtn.getGlobalBounds().contains(mousePos)) {
         std::system("open \"../assets/gameResults.txt\"");
     }
 }
-void Game::handleInput() {
-    sf::Event event;
-    while (window.pollEvent(event)) {
-        if (event.type == sf::Event::Closed)
-            window.close();
-        else if (event.type == sf::Event::TextEntered) {
-            if (event.text.unicode < 128) {
-                char typedChar = static_cast<char>(event.text.unicode);
-                if (typedChar == '\b') {
-                    if (!typedWord.empty()) {
-                        typedWord.pop_back();
-                    }
-                } else if (typedChar == '\r' || typedChar == '\n') {
-                    auto wordIter = std::find_if(wordsOnScreen.begin(), wordsOnScreen.end(),
-                                                 [this](const ActiveWord& word) {
-                                                     return word.fullWord == typedWord;
-                                                 });
-                    if (wordIter != wordsOnScreen.end()) {
-                        wordsOnScreen.erase(wordIter);
-                        typedWord.clear();
-                        points++;
-                    }
-                } else {
-                    typedWord += typedChar;
-                }
-
-                ActiveWord* closestWord = nullptr;
-                float maxPositionX = -1.0f;
-                for (auto& word : wordsOnScreen) {
-                    if (word.fullWord.substr(0, typedWord.length()) == typedWord) {
-                        if (word.text.getPosition().x > maxPositionX) {
-                            closestWord = &word;
-                            maxPositionX = word.text.getPosition().x;
-                        }
-                    }
-                }
-
-                for (auto& word : wordsOnScreen) {
-                    if (&word == closestWord) {
-                        word.typedPart = typedWord;
-                    } else {
-                        word.typedPart = "";
-                    }
-                }
-            }
-        } else if (event.type == sf::Event::MouseButtonPressed) {
-            sf::Vector2f mousePos = window.mapPixelToCoords(sf::Mouse::getPosition(window));
-            if (gameStatus == Ended) {
-                handleGameOverScreenMouseClick(mousePos);
-            } else {
-                handleMouseClick(mousePos);
-            }
-        } else if (event.type == sf::Event::KeyPressed) {
-            if (event.key.code == sf::Keyboard::Escape) {
-                if (gameStatus == Active) {
-                    gameStatus = Paused;
-                    paused = true;
-                    pausedTime = gameClock.getElapsedTime();
-                } else if (gameStatus == Paused) {
-                    gameStatus = Active;
-                    paused = false;
-                    gameClock.restart();
-                    timeElapsed -= pausedTime.asSeconds();
-                }
-            } else if (event.type == sf::Event::Resized) {
-                sf::FloatRect visibleArea(0, 0, event.size.width, event.size.height);
-                window.setView(sf::View(visibleArea));
-                setupLayout();
-            }
-        }
+// Typing goes straight to the simulation thread without waiting for the frame lock.
+bool Game::handleInputAsync(const sf::Event &event) {
+    if (event.type == sf::Event::TextEntered && simulationRunning && !simulationPaused) {
+        typedChars.push(event.text.unicode);
+        return true;
     }
+    return false;
 }
-
-void Game::reset() {
-    gameStatus = RestartMenu;
-}
-void Game::updateGame() {
-    if (gameStatus == Active && !paused) {
-        dt = gameClock.restart().asSeconds();
-        updateWords();
-
-        if (timeElapsed >= spawnInterval) {
-            if (lives > 0) {
-                spawnWord();
-                ++wordCount;
-                timeElapsed = 0.0;
-                if (wordCount % 15 == 0) {
-                    speed += 10.0;
-                    spawnInterval = std::max(static_cast<float>(spawnInterval - 0.5f), 0.5f);
-                }
-            }
+void Game::handleInput(const sf::Event &event) {
+    TRACE_ZONE("Game::handleInput");
+    if (event.type == sf::Event::Closed)
+        closing = true;
+    else if (event.type == sf::Event::MouseButtonPressed) {
+        sf::Vector2f mousePos = window.mapPixelToCoords(sf::Mouse::getPosition(window));
+        if (gameStatus == Ended) {
+            handleGameOverScreenMouseClick(mousePos);
+        } else {
+            handleMouseClick(mousePos);
         }
-        timeElapsed += dt;
-        removeOutOfBoundsWords();
-        if (lives <= 0) {
-            std::cerr << "Game Over: No lives left." << std::endl;
-            gameStatus = Ended;
-            wordsOnScreen.clear();
-            saveResult();
+    } else if (event.type == sf::Event::KeyPressed) {
+        if (event.key.code == sf::Keyboard::Escape) {
+            if (gameStatus == Active) {
+                gameStatus = Paused;
+                simulationPaused = true;
+            } else if (gameStatus == Paused) {
+                gameStatus = Active;
+                simulationPaused = false;
+            }
         }
+    } else if (event.type == sf::Event::Resized) {
+        sf::FloatRect visibleArea(0, 0, event.size.width, event.size.height);
+        window.setView(sf::View(visibleArea));
+        setupLayout();
     }
 }
-void Game::spawnWord() {
-    ActiveWord newWord;
-    newWord.fullWord = wordList[rand() % wordList.size()];
-    newWord.typedPart = "";
-    newWord.text.setString(newWord.fullWord);
-    newWord.text.setFont(gameFont);
-    newWord.text.setCharacterSize(fontSize);
-    newWord.text.setFillColor(color);
-
-    float x = -newWord.text.getLocalBounds().width;
-    float maxY = static_cast<float>(window.getSize().y - newWord.text.getLocalBounds().height - 130);
-    float minY = 0.0f;
-    float scorePanelHeight = 100.0f;
-    float y = static_cast<float>(std::rand() % static_cast<int>(maxY - minY - scorePanelHeight)) + minY;
-    newWord.text.setPosition(x, y);
 
-    wordsOnScreen.push_back(newWord);
-}
-void Game::updateWords() {
-    for (auto& word : wordsOnScreen) {
-        word.text.move(speed * dt, 0);
-    }
-}
-void Game::removeOutOfBoundsWords() {
-    wordsOnScreen.erase(std::remove_if(wordsOnScreen.begin(), wordsOnScreen.end(),
-                                       [this](const ActiveWord &word) {
-                                           if (word.text.getPosition().x > window.getSize().x) {
-                                               --lives;
-                                               return true;
-                                           }
-                                           return false;
-                                       }), wordsOnScreen.end());
+void Game::reset() {
+    // The menu can switch the word list, so the old game must not be reading it any more.
+    stopSimulation();
+    savedGames.discard();
+    // A resumed game skipped loading the fonts the menu offers.
+    resources.load();
+    gameStatus = RestartMenu;
 }
 
 void Game::saveResult() const {
+    TRACE_ZONE("Game::saveResult");
     std::ofstream file("../assets/gameResults.txt", std::ios::app);
     if (file.is_open()) {
         std::time_t t = std::time(nullptr);
@@ -629,4 +1057,57 @@ void Game::saveResult() const {
     } else {
         std::cerr << "Failed to open game_results.txt for writing." << std::endl;
     }
-}
\ No newline at end of file
+}
+// Runs on the logic thread during a game, and on the calling thread once it has stopped.
+void Game::saveGame() {
+    TRACE_ZONE("Game::saveGame");
+    simulation.saveState(savedGame.state);
+    encodeSavedGame(savedGame, savedGameBytes);
+    savedGames.submit(savedGameBytes);
+}
+
+// Stops the saver, so nothing this Game does touches the saved game file.
+void Game::disableSaving() {
+    savedGames.stop();
+}
+
+// Saves a stopped solo game so the next launch resumes it. Returns false if there is nothing to resume.
+bool Game::suspend() {
+    if (!autosaving || !savedGames.isRunning() || simulation.isOver() || (gameStatus != Active && gameStatus != Paused)) {
+        return false;
+    }
+    saveGame();
+    return true;
+}
+
+bool Game::resume(const SavedGame &saved) {
+    setCategory(saved.category);
+    if (corpus->words.empty() && !wordStream.isOpen()) {
+        std::cerr << "Discarding the saved game: no words loaded for " << saved.category << "." << std::endl;
+        savedGames.discard();
+        return false;
+    }
+    savedGame = saved;
+    chosenFont = saved.font >= 0 && saved.font < Resources::FontCount ? saved.font : 0;
+    changeFont(resources.getFont(chosenFont));
+    changeFontSize(std::max(saved.fontSize, 1));
+    resuming = true;
+    return true;
+}
+
+void Game::saveSession() const {
+    TRACE_ZONE("Game::saveSession");
+    if (!recorder.isRecording()) {
+        return;
+    }
+    std::error_code error;
+    std::filesystem::create_directories("../assets/sessions", error);
+    std::time_t t = std::time(nullptr);
+    std::tm tm = *std::localtime(&t);
+    std::ostringstream filename;
+    filename << "../assets/sessions/" << std::put_time(&tm, "%Y%m%d-%H%M%S") << "-" << simulation.getPoints() << "-"
+             << std::hex << std::random_device{}() << ".session";
+    if (!recorder.save(filename.str(), simulation.getPoints())) {
+        std::cerr << "Failed to save session to " << filename.str() << std::endl;
+    }
+}
@@ -5,78 +5,156 @@
 #include <vector>
 #include <string>
 #include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include "wordstream.h"
+#include "corpus.h"
+#include "embeddedassets.h"
+#include "framearena.h"
+#include "wordwatcher.h"
+#include "simulation.h"
+#include "spscqueue.h"
+#include "triplebuffer.h"
+#include "raceclient.h"
+#include "layer.h"
+#include "resources.h"
+#include "scene.h"
+#include "sessionlog.h"
+#include "savegame.h"
 
-class Game {
+class Game : public Scene {
 public:
-    Game(sf::RenderWindow &);
-    void start();
+    Game(sf::RenderWindow &, Resources &);
+    ~Game() override;
+    void enter() override;
+    bool handleInputAsync(const sf::Event &event) override;
+    void handleInput(const sf::Event &event) override;
+    void update() override;
+    void render() override;
+    bool isSteady() const override;
     void setCategory(const std::string &category);
     void changeFont(const sf::Font &newFont);
     void changeFontSize(int newSize);
     int getFontSize() const;
+    bool joinRace(const std::string &host, std::uint16_t port);
+    // Picks up a saved game the next time the game starts, with the category and font it was played in.
+    // Returns false, and deletes the save, if its word list can no longer be loaded.
+    bool resume(const SavedGame &saved);
+    // For tools that drive a Game without a player: games are no longer saved, so the player's save is left alone.
+    void disableSaving();
+
+    static constexpr const char *savedGameFile = "../assets/savedgame.bin";
 
     enum GameState { Active, Paused, Ended, RestartMenu } gameStatus = Active;
 private:
     sf::RenderWindow &window;
-    sf::Font gameFont;
+    Resources &resources;
+    const sf::Font &fontTNR, &fontBold, &fontHorror, &fontRoboto;
+    const sf::Texture &bgTexture;
+    const sf::Font *gameFont;
     sf::Color color;
-    float dt;
     int fontSize;
-    float speed;
     int points;
-    int wordCount;
-    float spawnInterval;
-    float timeElapsed;
     std::string currentCategory;
     std::string categoryFilePath;
-    std::vector<std::string> wordList;
+    // Replaced whole on every category change or reload. Measured here between games; running games only read it.
+    std::shared_ptr<Corpus> corpus = std::make_shared<Corpus>();
+    WordListWatcher wordWatcher;
+    const sf::Font *measuredFont = nullptr;
+    int measuredSize = 0;
+    const sf::Font *warmedFont = nullptr;
+    int warmedSize = 0;
+    WordStream wordStream;
     std::vector<sf::Text> textItems;
-    bool paused = false;
-    sf::Clock gameClock;
-    sf::Time pausedTime;
-    sf::Texture bgTexture;
     sf::Sprite bgImage;
+    // A partly typed word is drawn as two pieces. These and the scratch strings keep their buffers
+    // between frames, so drawing a frame of a game in progress does not allocate.
+    sf::Text wordText, highlightedText, remainingText;
+    sf::String wordScratch, hudScratch;
+    FrameArena frameArena;
+
+    // The simulation runs on its own thread while a game is in progress.
+    // Typed characters reach it through typedChars, and it publishes its state through snapshots.
+    Simulation simulation;
+    SpscQueue<sf::Uint32, 256> typedChars;
+    TripleBuffer<Simulation::Snapshot> snapshots;
+    std::thread logicThread;
+    std::atomic<bool> simulationRunning{false};
+    std::atomic<bool> simulationPaused{false};
+    Simulation::Config activeConfig;
+    // A reloaded word list waiting for the logic thread to swap it in at the start of its next step.
+    std::mutex incomingMutex;
+    std::shared_ptr<const Corpus> incomingCorpus;
+    std::atomic<bool> corpusIncoming{false};
+    // Solo games with an in-memory word list are recorded so their score can be verified offline.
+    SessionRecorder recorder;
+    // Solo games are saved every second of play and when the player leaves, so they can resume after
+    // a restart or a crash. The logic thread owns savedGame and savedGameBytes while a game runs.
+    SavedGameWriter savedGames;
+    SavedGame savedGame;
+    std::vector<std::uint8_t> savedGameBytes;
+    bool autosaving = false;
+    bool resuming = false;
 
-    struct ActiveWord {
-        std::string fullWord;
-        std::string typedPart;
-        sf::Text text;
-    };
+    // Race mode: spawns come from the server, and everyone's score is shown in the top-left corner.
+    RaceClient race;
+    std::uint16_t racePlayerId = 0;
+    std::string raceCategory;
+    std::vector<RaceStanding> liveRaceStandings;
+    std::vector<RaceStanding> raceStandings;
+    sf::Text raceText;
 
-    std::vector<ActiveWord> wordsOnScreen;
-    std::string typedWord;
+    // Score state as of the last snapshot the render thread picked up.
+    sf::String typedWord;
     int lives = 5;
+    int shownPoints = -1;
+    int shownLives = -1;
+    sf::String shownTyped;
+
+    enum LayerId { BackgroundLayer, HudLayer, OverlayLayer, LayerCount };
+    Layer layers[LayerCount];
+    GameState overlayState = Active;
 
     void updateElementPositions();
     void loadResources();
     void setupLayout();
-    void displayRestartMenu();
+    void displayRestartMenu(sf::RenderTarget &target);
     void uploadWordsFromFile(const std::string &filename);
-    void handleInput();
-    void render();
+    void measureWords();
+    void adoptReloadedCorpus(std::shared_ptr<Corpus> reloaded, const std::string &file);
+    void prewarmGlyphs();
+    void primeTextBuffers();
+    void redrawLayers();
+    void markLayersDirty();
     void displayWords();
-    void updateWords();
-    void removeOutOfBoundsWords();
     void saveResult() const;
-    void spawnWord();
-    void displayScorePanel();
-    void displayGameOver();
-    void displayPauseBtn();
-    void displayResumeBtn();
-    void displayExitBtn();
-    void displayRestartBtn();
-    void displayResultsBtn();
+    void saveSession() const;
+    void saveGame();
+    bool suspend();
+    void startSimulation();
+    void stopSimulation();
+    void runSimulation();
+    Simulation::Config simulationConfig() const;
+    void pollRace(bool &waitingForRace);
+    void displayRaceStandings();
+    void displayScorePanel(sf::RenderTarget &target);
+    void displayGameOver(sf::RenderTarget &target);
+    void displayPauseBtn(sf::RenderTarget &target);
+    void displayResumeBtn(sf::RenderTarget &target);
+    void displayExitBtn(sf::RenderTarget &target);
+    void displayRestartBtn(sf::RenderTarget &target);
+    void displayResultsBtn(sf::RenderTarget &target);
     void handleMouseClick(sf::Vector2f mousePos);
     void handleGameOverScreenMouseClick(sf::Vector2f mousePos);
     void reset();
-    void updateGame();
     void updateChosenFontColor(int selectedFontType);
 
     sf::RectangleShape scoreBg, pauseBtn, resumeBtn, exitBtn, restartBtn, resultsBtn;
     sf::Text scoreText, typedText, livesText, pauseBtnText, resumeBtnText, exitBtnText, restartBtnText, resultsText, homeTxt;
 
     //for restart
-    sf::Font fontTNR, fontBold, fontHorror, fontRoboto;
     sf::RectangleShape TNRButton, robotoButton, HorrorButton, boldButton, increaseButton, decreaseButton, confirmBtn;
     sf::Text TNRText, robotoText, horrorText, boldText, increaseSizeButtonText, decreaseSizeButtonText, currentFontSizeText, confirmBtnText;
     std::vector<sf::Text> TopicMenuOptions;
@@ -0,0 +1,71 @@
+#ifndef PROJECT_LATENCYHISTOGRAM_H
+#define PROJECT_LATENCYHISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+// Log-linear histogram of nanosecond durations: 16 linear sub-buckets per power of two,
+// so percentiles are accurate to about 6% with a fixed 8 KiB footprint (1024 64-bit counters).
+class LatencyHistogram {
+public:
+    void record(std::uint64_t nanoseconds) {
+        ++buckets[bucketFor(nanoseconds)];
+        ++count;
+        maximum = std::max(maximum, nanoseconds);
+    }
+
+    void merge(const LatencyHistogram &other) {
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            buckets[i] += other.buckets[i];
+        }
+        count += other.count;
+        maximum = std::max(maximum, other.maximum);
+    }
+
+    std::uint64_t percentile(double fraction) const {
+        if (count == 0) {
+            return 0;
+        }
+        std::uint64_t rank = static_cast<std::uint64_t>(fraction * static_cast<double>(count - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                return std::min(upperBound(i), maximum);
+            }
+        }
+        return maximum;
+    }
+
+    std::uint64_t getCount() const { return count; }
+    std::uint64_t getMaximum() const { return maximum; }
+
+private:
+    static constexpr unsigned subBits = 4;
+
+    static std::size_t bucketFor(std::uint64_t value) {
+        if (value < (1u << subBits)) {
+            return static_cast<std::size_t>(value);
+        }
+        unsigned exponent = static_cast<unsigned>(std::bit_width(value)) - subBits - 1;
+        std::uint64_t mantissa = (value >> exponent) & ((1u << subBits) - 1);
+        return static_cast<std::size_t>(((exponent + 1) << subBits) + mantissa);
+    }
+
+    static std::uint64_t upperBound(std::size_t bucket) {
+        if (bucket < (1u << subBits)) {
+            return bucket;
+        }
+        unsigned exponent = static_cast<unsigned>(bucket >> subBits) - 1;
+        std::uint64_t mantissa = (bucket & ((1u << subBits) - 1)) | (1u << subBits);
+        return ((mantissa + 1) << exponent) - 1;
+    }
+
+    std::array<std::uint64_t, 64 << subBits> buckets{};
+    std::uint64_t count = 0;
+    std::uint64_t maximum = 0;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#include "layer.h"
+#include <iostream>
+
+void Layer::resize(sf::Vector2u size) {
+    sf::Vector2u current = texture.getSize();
+    if (current.x == size.x && current.y == size.y) {
+        return;
+    }
+    if (!texture.create(size.x, size.y)) {
+        std::cerr << "Failed to create layer texture." << std::endl;
+        return;
+    }
+    sprite.setTexture(texture.getTexture(), true);
+    dirty = true;
+}
+
+void Layer::markDirty() {
+    dirty = true;
+}
+
+bool Layer::isDirty() const {
+    return dirty;
+}
+
+sf::RenderTarget &Layer::beginRedraw() {
+    texture.clear(sf::Color::Transparent);
+    return texture;
+}
+
+void Layer::endRedraw() {
+    texture.display();
+    dirty = false;
+}
+
+void Layer::draw(sf::RenderTarget &target) const {
+    target.draw(sprite);
+}
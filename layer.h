@@ -0,0 +1,23 @@
+#ifndef PROJECT_LAYER_H
+#define PROJECT_LAYER_H
+
+#include <SFML/Graphics.hpp>
+
+// A cached render of rarely changing drawables.
+// The layer is redrawn into its texture only after markDirty(), and is otherwise drawn as one sprite.
+class Layer {
+public:
+    void resize(sf::Vector2u size);
+    void markDirty();
+    bool isDirty() const;
+    sf::RenderTarget &beginRedraw();
+    void endRedraw();
+    void draw(sf::RenderTarget &target) const;
+
+private:
+    sf::RenderTexture texture;
+    sf::Sprite sprite;
+    bool dirty = true;
+};
+
+#endif
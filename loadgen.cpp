@@ -0,0 +1,138 @@
+#include "bot.h"
+#include "corpus.h"
+#include "latencyhistogram.h"
+#include "simulation.h"
+#include "workpool.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace {
+    struct Options {
+        int sessions = 1000;
+        unsigned threads = std::thread::hardware_concurrency();
+        double wordsPerMinute = 60;
+        double errorRate = 0.05;
+        float maxSeconds = 600;
+        float stepSeconds = Simulation::stepSeconds;
+        std::string category = "Mix";
+    };
+
+    struct WorkerStats {
+        LatencyHistogram stepLatency;
+        std::uint64_t sessions = 0;
+        std::uint64_t keystrokes = 0;
+        std::uint64_t steps = 0;
+        std::uint64_t points = 0;
+    };
+
+    Options parseOptions(int argc, char *argv[]) {
+        Options options;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            std::string name = argv[i];
+            std::string value = argv[i + 1];
+            if (name == "--sessions") {
+                options.sessions = std::stoi(value);
+            } else if (name == "--threads") {
+                options.threads = static_cast<unsigned>(std::stoul(value));
+            } else if (name == "--wpm") {
+                options.wordsPerMinute = std::stod(value);
+            } else if (name == "--errors") {
+                options.errorRate = std::stod(value);
+            } else if (name == "--seconds") {
+                options.maxSeconds = std::stof(value);
+            } else if (name == "--category") {
+                options.category = value;
+            } else {
+                std::cerr << "Unknown option " << name << std::endl;
+                std::exit(2);
+            }
+        }
+        return options;
+    }
+
+    // Plays one full game in simulated time and records how long each step took for real.
+    void playSession(const Options &options, const std::shared_ptr<const Corpus> &corpus, std::uint32_t seed, WorkerStats &stats) {
+        Simulation simulation;
+        simulation.setWordSource(corpus, nullptr);
+        simulation.reset(Simulation::Config(), seed);
+        BotProfile profile;
+        profile.wordsPerMinute = options.wordsPerMinute;
+        profile.errorRate = options.errorRate;
+        Bot bot(profile, seed ^ 0x9e3779b9u);
+
+        std::vector<sf::Uint32> keys;
+        int maxSteps = static_cast<int>(options.maxSeconds / options.stepSeconds);
+        for (int step = 0; step < maxSteps && !simulation.isOver(); ++step) {
+            keys.clear();
+            bot.think(simulation, options.stepSeconds, keys);
+
+            auto start = std::chrono::steady_clock::now();
+            for (sf::Uint32 key : keys) {
+                simulation.typeChar(key);
+            }
+            simulation.step(options.stepSeconds);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            stats.stepLatency.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            stats.keystrokes += keys.size();
+            ++stats.steps;
+        }
+        stats.points += static_cast<std::uint64_t>(simulation.getPoints());
+        ++stats.sessions;
+    }
+}
+
+// Usage: monkeytyper_loadgen [--sessions N] [--threads T] [--wpm W] [--errors P] [--seconds S] [--category C]
+int main(int argc, char *argv[]) {
+    Options options = parseOptions(argc, argv);
+    auto corpus = std::make_shared<Corpus>();
+    if (!loadCorpus("../assets/" + options.category + ".txt", *corpus) || corpus->words.empty()) {
+        std::cerr << "No words loaded from file ../assets/" << options.category << ".txt" << std::endl;
+        return 1;
+    }
+
+    // Bots play with every character as wide as the default estimate.
+    std::vector<WordIndex::Advance> advances;
+    for (sf::Uint32 c : corpus->index.getCharacters()) {
+        advances.emplace_back(c, Simulation::Config().charWidth);
+    }
+    corpus->index.measure(corpus->words, advances);
+
+    WorkPool pool(options.threads);
+    std::vector<WorkerStats> stats(pool.size());
+    auto start = std::chrono::steady_clock::now();
+    for (int session = 0; session < options.sessions; ++session) {
+        pool.submit([&, session](unsigned worker) {
+            playSession(options, corpus, static_cast<std::uint32_t>(session) * 2654435761u + 1, stats[worker]);
+        });
+    }
+    pool.wait();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    WorkerStats total;
+    for (const auto &worker : stats) {
+        total.stepLatency.merge(worker.stepLatency);
+        total.sessions += worker.sessions;
+        total.keystrokes += worker.keystrokes;
+        total.steps += worker.steps;
+        total.points += worker.points;
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "threads          " << pool.size() << "\n"
+              << "sessions         " << total.sessions << " in " << seconds << " s\n"
+              << "sessions/sec     " << total.sessions / seconds << "\n"
+              << "keystrokes/sec   " << total.keystrokes / seconds << "\n"
+              << "steps/sec        " << total.steps / seconds << "\n"
+              << "mean score       " << (total.sessions ? static_cast<double>(total.points) / total.sessions : 0.0) << "\n"
+              << "step latency ns  p50 " << total.stepLatency.percentile(0.50)
+              << "  p90 " << total.stepLatency.percentile(0.90)
+              << "  p99 " << total.stepLatency.percentile(0.99)
+              << "  p99.9 " << total.stepLatency.percentile(0.999)
+              << "  max " << total.stepLatency.getMaximum() << std::endl;
+    return 0;
+}
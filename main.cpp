@@ -1,11 +1,45 @@
-#include "cmake-build-debug/game.h"
-#include "cmake-build-debug/start.h"
+#include "game.h"
+#include "start.h"
+#include "resources.h"
+#include "savegame.h"
+#include "scene.h"
 #include <SFML/Graphics.hpp>
+#include <optional>
+#include <string>
 
-int main() {
+// Usage: Project [--race <host> <port>]
+// A solo game left through the exit button, or cut short by a crash, resumes on the next launch,
+// straight into the game and with only the font it was played in loaded. A save whose word list
+// is gone is deleted, and the Start menu shows as usual.
+int main(int argc, char *argv[]) {
     sf::RenderWindow window(sf::VideoMode(1200, 800), "MonkeyTyper");
-    Game game(window);
-    Start start(game);
-    start.update();
+    bool racing = argc >= 4 && std::string(argv[1]) == "--race";
+    SavedGame saved;
+    bool resuming = !racing && readSavedGame(Game::savedGameFile, saved);
+    Resources resources;
+    if (resuming) {
+        resources.loadFor(saved.font);
+    } else {
+        resources.load();
+    }
+    Game game(window, resources);
+    if (racing) {
+        if (!game.joinRace(argv[2], static_cast<std::uint16_t>(std::stoi(argv[3])))) {
+            return 1;
+        }
+    }
+    SceneManager scenes(window);
+    std::optional<Start> start;
+    if (resuming && !game.resume(saved)) {
+        resuming = false;
+        resources.load();
+    }
+    if (resuming) {
+        scenes.push(game);
+    } else {
+        start.emplace(scenes, game, resources);
+        scenes.push(*start);
+    }
+    scenes.run();
     return 0;
-}
\ No newline at end of file
+}
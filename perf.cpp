@@ -0,0 +1,436 @@
+#include "alloctracker.h"
+#include "bot.h"
+#include "corpus.h"
+#include "game.h"
+#include "latencyhistogram.h"
+#include "resources.h"
+#include "simulation.h"
+#include "wordindex.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#ifndef MONKEYTYPER_ALLOC_TRACKING
+#error "monkeytyper_perf reports allocations per frame and must be built with MONKEYTYPER_ALLOC_TRACKING"
+#endif
+
+namespace {
+    const char *categories[] = {"Mix", "Food", "Technology", "Entertainment"};
+
+    struct Budget {
+        std::uint64_t p99Nanoseconds = 0;
+        double allocationsPerFrame = -1;
+        long peakRssKilobytes = 0;
+    };
+
+    enum Outcome { Completed, Skipped, LoadFailed };
+
+    // A frame is one unit of work the scenario repeats: a simulation step, a category switch, a re-measure or a drawn frame.
+    class Frames {
+    public:
+        template <typename Work>
+        void run(Work &&work) {
+            allocations += measure(work).totalCalls();
+        }
+
+        // A frame of a running Game. Only the phases the game checks are counted, leaving out what graphics
+        // drivers and SFML's own threads allocate, and the frame goes through the tracker's steady-frame check.
+        template <typename Work>
+        void runGameFrame(Work &&work, bool steady) {
+            AllocCounts counts = measure(work);
+            allocations += counts.calls[AllocUpdate] + counts.calls[AllocRender] + counts.calls[AllocLogic];
+            endAllocFrame(counts, steady);
+        }
+
+        LatencyHistogram latency;
+        std::uint64_t allocations = 0;
+
+    private:
+        template <typename Work>
+        AllocCounts measure(Work &&work) {
+            takeAllocCounts();
+            auto start = std::chrono::steady_clock::now();
+            work();
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            latency.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            return takeAllocCounts();
+        }
+    };
+
+    long peakRssKilobytes() {
+#ifndef _WIN32
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+            return usage.ru_maxrss / 1024;
+#else
+            return usage.ru_maxrss;
+#endif
+        }
+#endif
+        return 0;
+    }
+
+    // Advances roughly like a proportional font at the given size.
+    std::vector<WordIndex::Advance> advancesFor(const WordIndex &index, int fontSize) {
+        std::vector<WordIndex::Advance> advances;
+        for (sf::Uint32 c : index.getCharacters()) {
+            advances.emplace_back(c, fontSize * (0.45f + static_cast<float>(c % 5) * 0.05f));
+        }
+        return advances;
+    }
+
+    std::shared_ptr<Corpus> loadCategory(const std::string &category) {
+        auto corpus = std::make_shared<Corpus>();
+        if (!loadCorpus("../assets/" + category + ".txt", *corpus) || corpus->words.empty()) {
+            return nullptr;
+        }
+        corpus->index.measure(corpus->words, advancesFor(corpus->index, 30));
+        return corpus;
+    }
+
+    void typeAndStep(Simulation &simulation, Bot &bot, std::vector<sf::Uint32> &keys, Frames &frames) {
+        keys.clear();
+        bot.think(simulation, Simulation::stepSeconds, keys);
+        frames.run([&] {
+            for (sf::Uint32 key : keys) {
+                simulation.typeChar(key);
+            }
+            simulation.step(Simulation::stepSeconds);
+        });
+    }
+
+    // Ten minutes of play by a fast typist who never runs out of lives.
+    Outcome marathon(Frames &frames) {
+        std::shared_ptr<Corpus> corpus = loadCategory("Mix");
+        if (!corpus) {
+            return LoadFailed;
+        }
+        Simulation simulation;
+        simulation.setWordSource(corpus, nullptr);
+        Simulation::Config config;
+        config.lives = 1 << 30;
+        simulation.reset(config, 1);
+        BotProfile profile;
+        profile.wordsPerMinute = 80;
+        Bot bot(profile, 1);
+        std::vector<sf::Uint32> keys;
+        const int steps = static_cast<int>(600 / Simulation::stepSeconds);
+        for (int step = 0; step < steps; ++step) {
+            typeAndStep(simulation, bot, keys, frames);
+        }
+        return Completed;
+    }
+
+    // Keeps 500 words on screen while a typist works through them.
+    Outcome crowd(Frames &frames) {
+        std::shared_ptr<Corpus> corpus = loadCategory("Mix");
+        if (!corpus) {
+            return LoadFailed;
+        }
+        Simulation simulation;
+        simulation.setWordSource(corpus, nullptr);
+        Simulation::Config config;
+        config.width = 1e9f;
+        config.scheduledSpawns = false;
+        simulation.reset(config, 2);
+        Bot bot(BotProfile(), 2);
+        std::vector<sf::Uint32> keys;
+        std::uint32_t nextPick = 0;
+        for (int step = 0; step < 1200; ++step) {
+            while (simulation.getWords().size() < 500) {
+                SpawnPick pick;
+                pick.wordIndex = nextPick++ % static_cast<std::uint32_t>(corpus->words.size());
+                pick.yFraction = static_cast<std::uint16_t>(nextPick * 40503u);
+                simulation.spawnFromServer(pick);
+            }
+            typeAndStep(simulation, bot, keys, frames);
+        }
+        return Completed;
+    }
+
+    // Loading and measuring word lists the way Game::setCategory and the next game's start do, but without a Game,
+    // so it runs headless. The categories scenario goes through Game itself.
+    Outcome wordListLoads(Frames &frames) {
+        std::shared_ptr<Corpus> corpus;
+        for (int i = 0; i < 400; ++i) {
+            const char *category = categories[i % std::size(categories)];
+            frames.run([&] {
+                corpus = loadCategory(category);
+            });
+            if (!corpus) {
+                return LoadFailed;
+            }
+        }
+        return Completed;
+    }
+
+    // Re-measuring a word list at every size the menu allows, with made-up advances so it runs headless.
+    // The fontsizes scenario goes through Game itself.
+    Outcome remeasures(Frames &frames) {
+        std::shared_ptr<Corpus> corpus = loadCategory("Mix");
+        if (!corpus) {
+            return LoadFailed;
+        }
+        for (int pass = 0; pass < 10; ++pass) {
+            for (int fontSize = 8; fontSize <= 72; ++fontSize) {
+                std::vector<WordIndex::Advance> advances = advancesFor(corpus->index, fontSize);
+                frames.run([&] {
+                    corpus->index.measure(corpus->words, advances);
+                });
+            }
+        }
+        return Completed;
+    }
+
+    // Game needs fonts and textures, which need a display to make a GL context on.
+    bool hasDisplay() {
+#ifdef __linux__
+        return std::getenv("DISPLAY") || std::getenv("WAYLAND_DISPLAY");
+#else
+        return true;
+#endif
+    }
+
+    // A Game on a hidden window, with saving off so the player's saved game is left alone.
+    class HiddenGame {
+    public:
+        bool open() {
+            window.setVisible(false);
+            window.setFramerateLimit(120);
+            if (!resources.load()) {
+                return false;
+            }
+            game.emplace(window, resources);
+            game->disableSaving();
+            return true;
+        }
+
+        sf::RenderWindow window{sf::VideoMode(1200, 800), "monkeytyper_perf"};
+        Resources resources;
+        std::optional<Game> game;
+    };
+
+    // Game::setCategory, switching between the word lists as fast as possible.
+    Outcome categorySwitching(Frames &frames) {
+        if (!hasDisplay()) {
+            return Skipped;
+        }
+        HiddenGame hidden;
+        if (!hidden.open()) {
+            return LoadFailed;
+        }
+        Game &game = *hidden.game;
+        for (int i = 0; i < 400; ++i) {
+            frames.run([&] {
+                game.setCategory(categories[i % std::size(categories)]);
+            });
+        }
+        return Completed;
+    }
+
+    // Game::changeFontSize across every size the menu allows. The new size is measured and its glyphs
+    // warmed when the next game starts, so each frame is the change plus Game::enter().
+    Outcome fontSizeSweep(Frames &frames) {
+        if (!hasDisplay()) {
+            return Skipped;
+        }
+        HiddenGame hidden;
+        if (!hidden.open()) {
+            return LoadFailed;
+        }
+        Game &game = *hidden.game;
+        game.setCategory("Mix");
+        for (int fontSize = 8; fontSize <= 72; ++fontSize) {
+            frames.run([&] {
+                game.changeFontSize(fontSize);
+                game.enter();
+            });
+            if (game.isClosing()) {
+                return LoadFailed;
+            }
+        }
+        return Completed;
+    }
+
+    // Game's own frames: taking the latest snapshot, then drawing the words and the HUD, through rounds that
+    // change the category and font size the way the restart menu does.
+    Outcome gameFrames(Frames &frames) {
+        if (!hasDisplay()) {
+            return Skipped;
+        }
+        HiddenGame hidden;
+        if (!hidden.open()) {
+            return LoadFailed;
+        }
+        Game &game = *hidden.game;
+        sf::RenderWindow &window = hidden.window;
+        const int fontSizes[] = {20, 30, 45, 60};
+        // As many as the tracker lets a game warm up for, so both start checking on the same frame.
+        const int warmupFrames = 120;
+        for (int round = 0; round < 8; ++round) {
+            game.setCategory(categories[round % std::size(categories)]);
+            game.changeFontSize(fontSizes[round % std::size(fontSizes)]);
+            game.enter();
+            if (game.isClosing()) {
+                return LoadFailed;
+            }
+            // Stands in for the menu frames between games, which restart the tracker's warm-up.
+            ALLOC_FRAME_END(false);
+            for (int frame = 0; frame < 240; ++frame) {
+                if (frame % 8 == 0) {
+                    sf::Event key{};
+                    key.type = sf::Event::TextEntered;
+                    key.text.unicode = 'a' + frame / 8 % 26;
+                    game.handleInputAsync(key);
+                }
+                window.clear();
+                auto draw = [&] {
+                    {
+                        ALLOC_PHASE(AllocUpdate);
+                        game.update();
+                    }
+                    ALLOC_PHASE(AllocRender);
+                    game.render();
+                };
+                if (frame < warmupFrames) {
+                    draw();
+                    ALLOC_FRAME_END(game.isSteady());
+                } else {
+                    frames.runGameFrame(draw, game.isSteady());
+                }
+                window.display();
+            }
+        }
+        return Completed;
+    }
+
+    const std::map<std::string, Outcome (*)(Frames &)> scenarios = {
+        {"marathon", marathon},
+        {"crowd", crowd},
+        {"wordlists", wordListLoads},
+        {"remeasures", remeasures},
+        {"categories", categorySwitching},
+        {"fontsizes", fontSizeSweep},
+        {"render", gameFrames},
+    };
+
+    // Each line is "<scenario> <metric> <limit>", with metrics p99Nanoseconds, allocationsPerFrame and peakRssKilobytes.
+    bool loadBudgets(const std::string &filename, std::map<std::string, Budget> &budgets) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open file: " << filename << std::endl;
+            return false;
+        }
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            ++lineNumber;
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::istringstream fields(line);
+            std::string scenario, metric;
+            double limit = 0;
+            if (!(fields >> scenario >> metric >> limit) || !scenarios.count(scenario)) {
+                std::cerr << filename << ":" << lineNumber << ": malformed budget" << std::endl;
+                return false;
+            }
+            Budget &budget = budgets[scenario];
+            if (metric == "p99Nanoseconds") {
+                budget.p99Nanoseconds = static_cast<std::uint64_t>(limit);
+            } else if (metric == "allocationsPerFrame") {
+                budget.allocationsPerFrame = limit;
+            } else if (metric == "peakRssKilobytes") {
+                budget.peakRssKilobytes = static_cast<long>(limit);
+            } else {
+                std::cerr << filename << ":" << lineNumber << ": unknown metric " << metric << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+// Usage: monkeytyper_perf [--budgets FILE] [scenario...]
+// Runs the scenarios and exits with 1 if any of them is over its budget, or with 3 as soon as a steady game
+// frame allocates. categories, fontsizes and render drive a Game on a hidden window; without a display they are
+// skipped, and a run that skipped every scenario it was given exits with 77.
+// Peak RSS is for the whole process, so run one scenario per process to budget it on its own.
+int main(int argc, char *argv[]) {
+    std::string budgetFile = "../assets/perfbudgets.txt";
+    std::vector<std::string> selected;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--budgets" && i + 1 < argc) {
+            budgetFile = argv[++i];
+        } else if (scenarios.count(argument)) {
+            selected.push_back(argument);
+        } else {
+            std::cerr << "Unknown scenario " << argument << std::endl;
+            return 2;
+        }
+    }
+    if (selected.empty()) {
+        for (const auto &scenario : scenarios) {
+            selected.push_back(scenario.first);
+        }
+    }
+    std::map<std::string, Budget> budgets;
+    if (!loadBudgets(budgetFile, budgets)) {
+        return 2;
+    }
+    // A steady game frame that allocates fails the run on the spot, with exit code 3.
+    setAllocStrict(true);
+
+    bool withinBudget = true;
+    std::size_t skipped = 0;
+    for (const auto &name : selected) {
+        Frames frames;
+        Outcome outcome = scenarios.at(name)(frames);
+        if (outcome == LoadFailed) {
+            std::cerr << name << ": failed to load assets" << std::endl;
+            return 2;
+        }
+        if (outcome == Skipped) {
+            std::cout << std::left << std::setw(12) << name << "skipped: no display" << std::endl;
+            ++skipped;
+            continue;
+        }
+        std::uint64_t count = frames.latency.getCount();
+        double allocationsPerFrame = count ? static_cast<double>(frames.allocations) / count : 0.0;
+        std::uint64_t p99 = frames.latency.percentile(0.99);
+        long peakRss = peakRssKilobytes();
+        std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(2)
+                  << "frames " << count << "  p99 " << p99 << " ns  max " << frames.latency.getMaximum()
+                  << " ns  allocations/frame " << allocationsPerFrame << "  peak RSS " << peakRss << " KiB" << std::endl;
+
+        const Budget &budget = budgets[name];
+        if (budget.p99Nanoseconds && p99 > budget.p99Nanoseconds) {
+            std::cout << "  over budget: p99 " << p99 << " ns > " << budget.p99Nanoseconds << " ns" << std::endl;
+            withinBudget = false;
+        }
+        if (budget.allocationsPerFrame >= 0 && allocationsPerFrame > budget.allocationsPerFrame) {
+            std::cout << "  over budget: allocations/frame " << allocationsPerFrame << " > " << budget.allocationsPerFrame << std::endl;
+            withinBudget = false;
+        }
+        if (budget.peakRssKilobytes && peakRss > budget.peakRssKilobytes) {
+            std::cout << "  over budget: peak RSS " << peakRss << " KiB > " << budget.peakRssKilobytes << " KiB" << std::endl;
+            withinBudget = false;
+        }
+    }
+    if (!withinBudget) {
+        return 1;
+    }
+    return skipped == selected.size() ? 77 : 0;
+}
@@ -0,0 +1,138 @@
+#include "raceclient.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+RaceClient::~RaceClient() {
+    disconnect();
+}
+
+bool RaceClient::connect(const std::string &host, std::uint16_t port) {
+    disconnect();
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+        std::cerr << "Failed to resolve race server " << host << std::endl;
+        return false;
+    }
+    for (addrinfo *address = addresses; address && fd < 0; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd >= 0 && ::connect(fd, address->ai_addr, address->ai_addrlen) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0) {
+        std::cerr << "Failed to connect to race server " << host << ":" << port << std::endl;
+        return false;
+    }
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    connected = true;
+    return true;
+}
+
+void RaceClient::disconnect() {
+    connected = false;
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    in.clear();
+    inOffset = 0;
+    out.clear();
+}
+
+bool RaceClient::isConnected() const {
+    return connected.load(std::memory_order_acquire);
+}
+
+void RaceClient::send(const RaceMessage &message) {
+    encodeRaceMessage(message, out);
+    flush();
+}
+
+void RaceClient::flush() {
+    std::size_t sent = 0;
+    while (fd >= 0 && sent < out.size()) {
+        ssize_t written = ::send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+        if (written > 0) {
+            sent += static_cast<std::size_t>(written);
+        } else if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            disconnect();
+            return;
+        }
+    }
+    out.erase(out.begin(), out.begin() + static_cast<long>(sent));
+}
+
+void RaceClient::receive() {
+    if (inOffset > 0) {
+        in.erase(in.begin(), in.begin() + static_cast<long>(inOffset));
+        inOffset = 0;
+    }
+    std::uint8_t buffer[4096];
+    while (fd >= 0) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            in.insert(in.end(), buffer, buffer + received);
+        } else if (received < 0 && errno == EINTR) {
+            continue;
+        } else if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            std::cerr << "Race server closed the connection." << std::endl;
+            disconnect();
+        }
+    }
+}
+
+bool RaceClient::poll(RaceMessage &message) {
+    flush();
+    long used = decodeRaceMessage(in.data() + inOffset, in.size() - inOffset, message);
+    if (used == 0) {
+        receive();
+        used = decodeRaceMessage(in.data() + inOffset, in.size() - inOffset, message);
+    }
+    if (used < 0) {
+        std::cerr << "Malformed message from race server." << std::endl;
+        disconnect();
+        return false;
+    }
+    inOffset += static_cast<std::size_t>(used);
+    return used > 0;
+}
+
+bool RaceClient::waitFor(RaceMessageType type, RaceMessage &message, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (fd >= 0) {
+        while (poll(message)) {
+            if (message.type == type) {
+                return true;
+            }
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0 || fd < 0) {
+            break;
+        }
+        pollfd waiting{fd, POLLIN, 0};
+        ::poll(&waiting, 1, static_cast<int>(remaining));
+    }
+    return false;
+}
@@ -0,0 +1,34 @@
+#ifndef PROJECT_RACECLIENT_H
+#define PROJECT_RACECLIENT_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "raceprotocol.h"
+
+// Connection to a RaceServer. After connect() every call is non-blocking except waitFor().
+// One thread at a time drives the connection; any thread may ask isConnected().
+class RaceClient {
+public:
+    ~RaceClient();
+
+    bool connect(const std::string &host, std::uint16_t port);
+    void disconnect();
+    bool isConnected() const;
+    void send(const RaceMessage &message);
+    bool poll(RaceMessage &message);
+    bool waitFor(RaceMessageType type, RaceMessage &message, int timeoutMs);
+
+private:
+    void receive();
+    void flush();
+
+    int fd = -1;
+    std::atomic<bool> connected{false};
+    std::vector<std::uint8_t> in;
+    std::size_t inOffset = 0;
+    std::vector<std::uint8_t> out;
+};
+
+#endif
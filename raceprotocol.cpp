@@ -0,0 +1,84 @@
+#include "raceprotocol.h"
+#include "byteorder.h"
+#include <algorithm>
+
+void encodeRaceMessage(const RaceMessage &message, std::vector<std::uint8_t> &out) {
+    out.push_back(message.type);
+    switch (message.type) {
+        case RaceWelcome:
+            put16(out, message.score.playerId);
+            out.push_back(static_cast<std::uint8_t>(std::min<std::size_t>(message.category.size(), 255)));
+            out.insert(out.end(), message.category.begin(), message.category.begin() + std::min<std::size_t>(message.category.size(), 255));
+            break;
+        case RaceStart:
+            put32(out, message.seed);
+            break;
+        case RaceSpawn:
+            put32(out, message.spawn.wordIndex);
+            put16(out, message.spawn.yFraction);
+            break;
+        case RaceScore:
+            put32(out, message.score.points);
+            out.push_back(message.score.lives);
+            break;
+        case RaceScores:
+            put16(out, message.score.playerId);
+            put32(out, message.score.points);
+            out.push_back(message.score.lives);
+            break;
+        case RaceHello:
+        case RaceFinish:
+            break;
+    }
+}
+
+long decodeRaceMessage(const std::uint8_t *data, std::size_t size, RaceMessage &message) {
+    if (size < 1) {
+        return 0;
+    }
+    message.type = static_cast<RaceMessageType>(data[0]);
+    const std::uint8_t *payload = data + 1;
+    std::size_t available = size - 1;
+    switch (message.type) {
+        case RaceWelcome: {
+            if (available < 3 || available < 3u + payload[2]) {
+                return 0;
+            }
+            message.score.playerId = read16(payload);
+            message.category.assign(payload + 3, payload + 3 + payload[2]);
+            return 4 + payload[2];
+        }
+        case RaceStart:
+            if (available < 4) {
+                return 0;
+            }
+            message.seed = read32(payload);
+            return 5;
+        case RaceSpawn:
+            if (available < 6) {
+                return 0;
+            }
+            message.spawn.wordIndex = read32(payload);
+            message.spawn.yFraction = read16(payload + 4);
+            return 7;
+        case RaceScore:
+            if (available < 5) {
+                return 0;
+            }
+            message.score.points = read32(payload);
+            message.score.lives = payload[4];
+            return 6;
+        case RaceScores:
+            if (available < 7) {
+                return 0;
+            }
+            message.score.playerId = read16(payload);
+            message.score.points = read32(payload + 2);
+            message.score.lives = payload[6];
+            return 8;
+        case RaceHello:
+        case RaceFinish:
+            return 1;
+    }
+    return -1;
+}
@@ -0,0 +1,46 @@
+#ifndef PROJECT_RACEPROTOCOL_H
+#define PROJECT_RACEPROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "spawnschedule.h"
+
+// Wire format for head-to-head races: a one-byte type followed by a fixed little-endian payload.
+//   Welcome  server -> client  u16 playerId, u8 length, category bytes; sent as soon as a client connects
+//   Hello    client -> server  (empty); the player has started a game and is ready to race
+//   Start    server -> clients u32 seed
+//   Spawn    server -> clients u32 wordIndex, u16 yFraction; clients map wordIndex into their length band
+//   Score    client -> server  u32 points, u8 lives
+//   Scores   server -> clients u16 playerId, u32 points, u8 lives
+//   Finish   server -> clients (empty)
+enum RaceMessageType : std::uint8_t {
+    RaceHello = 1,
+    RaceWelcome,
+    RaceStart,
+    RaceSpawn,
+    RaceScore,
+    RaceScores,
+    RaceFinish
+};
+
+struct RaceStanding {
+    std::uint16_t playerId = 0;
+    std::uint32_t points = 0;
+    std::uint8_t lives = 0;
+};
+
+struct RaceMessage {
+    RaceMessageType type = RaceHello;
+    std::uint32_t seed = 0;
+    std::string category;
+    SpawnPick spawn;
+    RaceStanding score;
+};
+
+void encodeRaceMessage(const RaceMessage &message, std::vector<std::uint8_t> &out);
+// Returns the number of bytes consumed, 0 if data does not hold a whole message yet, or -1 if it is malformed.
+long decodeRaceMessage(const std::uint8_t *data, std::size_t size, RaceMessage &message);
+
+#endif
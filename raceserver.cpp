@@ -0,0 +1,337 @@
+#include "raceserver.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    constexpr auto tickLength = std::chrono::milliseconds(50);
+    constexpr std::size_t maxPendingOutput = 1 << 20;
+    constexpr int maxEvents = 256;
+
+    bool setNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+}
+
+RaceServer::RaceServer(std::string category, std::size_t corpusSize, int playersPerRace)
+        : category(std::move(category)), corpusSize(corpusSize), playersPerRace(std::max(playersPerRace, 1)) {}
+
+RaceServer::~RaceServer() {
+    for (auto &entry : clients) {
+        close(entry.first);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+    }
+}
+
+bool RaceServer::listen(std::uint16_t requestedPort) {
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "Failed to create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(requestedPort);
+    if (bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+        ::listen(listenFd, SOMAXCONN) < 0 || !setNonBlocking(listenFd)) {
+        std::cerr << "Failed to listen on port " << requestedPort << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    socklen_t length = sizeof(address);
+    getsockname(listenFd, reinterpret_cast<sockaddr *>(&address), &length);
+    port = ntohs(address.sin_port);
+
+    epollFd = epoll_create1(0);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    if (epollFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) < 0) {
+        std::cerr << "Failed to set up epoll: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::uint16_t RaceServer::getPort() const {
+    return port;
+}
+
+void RaceServer::stop() {
+    stopping = true;
+}
+
+void RaceServer::run() {
+    epoll_event events[maxEvents];
+    auto lastTick = std::chrono::steady_clock::now();
+    auto nextTick = lastTick + tickLength;
+
+    while (!stopping) {
+        auto now = std::chrono::steady_clock::now();
+        int timeout = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(nextTick - now).count());
+        int count = epoll_wait(epollFd, events, maxEvents, std::max(timeout, 0));
+        if (count < 0 && errno != EINTR) {
+            std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+            auto found = clients.find(fd);
+            if (found == clients.end()) {
+                continue;
+            }
+            Client &client = found->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeClient(client);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                readClient(client);
+            }
+            if (!client.closed && (events[i].events & EPOLLOUT)) {
+                flush(client);
+            }
+        }
+
+        now = std::chrono::steady_clock::now();
+        if (now >= nextTick) {
+            tick(std::chrono::duration<float>(now - lastTick).count());
+            lastTick = now;
+            nextTick += tickLength;
+            if (nextTick < now) {
+                nextTick = now + tickLength;
+            }
+        }
+
+        for (auto it = clients.begin(); it != clients.end();) {
+            if (it->second.closed) {
+                close(it->first);
+                it = clients.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void RaceServer::acceptClients() {
+    while (true) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "accept failed: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        setNonBlocking(fd);
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            continue;
+        }
+        Client &client = clients[fd];
+        client.fd = fd;
+        client.playerId = nextPlayerId++;
+        client.score.playerId = client.playerId;
+        RaceMessage welcome;
+        welcome.type = RaceWelcome;
+        welcome.score.playerId = client.playerId;
+        welcome.category = category;
+        encodeRaceMessage(welcome, client.out);
+        flush(client);
+    }
+}
+
+void RaceServer::readClient(Client &client) {
+    std::uint8_t buffer[4096];
+    while (true) {
+        ssize_t received = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            client.in.insert(client.in.end(), buffer, buffer + received);
+            continue;
+        }
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            closeClient(client);
+            return;
+        }
+        if (errno != EINTR) {
+            break;
+        }
+    }
+
+    std::size_t offset = 0;
+    RaceMessage message;
+    while (offset < client.in.size()) {
+        long used = decodeRaceMessage(client.in.data() + offset, client.in.size() - offset, message);
+        if (used < 0) {
+            closeClient(client);
+            return;
+        }
+        if (used == 0) {
+            break;
+        }
+        offset += static_cast<std::size_t>(used);
+        handleMessage(client, message);
+    }
+    client.in.erase(client.in.begin(), client.in.begin() + static_cast<long>(offset));
+}
+
+void RaceServer::handleMessage(Client &client, const RaceMessage &message) {
+    if (message.type == RaceHello) {
+        client.joined = true;
+    } else if (message.type == RaceScore && client.racing) {
+        client.score.points = message.score.points;
+        client.score.lives = message.score.lives;
+        client.finished = message.score.lives == 0;
+        client.scoreChanged = true;
+    }
+}
+
+void RaceServer::flush(Client &client) {
+    std::size_t sent = 0;
+    while (sent < client.out.size()) {
+        ssize_t written = send(client.fd, client.out.data() + sent, client.out.size() - sent, MSG_NOSIGNAL);
+        if (written > 0) {
+            sent += static_cast<std::size_t>(written);
+        } else if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            closeClient(client);
+            return;
+        }
+    }
+    client.out.erase(client.out.begin(), client.out.begin() + static_cast<long>(sent));
+
+    bool wantsWrite = !client.out.empty();
+    if (wantsWrite != client.waitingToWrite) {
+        epoll_event event{};
+        event.events = wantsWrite ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        event.data.fd = client.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
+        client.waitingToWrite = wantsWrite;
+    }
+    if (client.out.size() > maxPendingOutput) {
+        std::cerr << "Dropping player " << client.playerId << ": not reading." << std::endl;
+        closeClient(client);
+    }
+}
+
+void RaceServer::closeClient(Client &client) {
+    if (!client.closed) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, client.fd, nullptr);
+        client.closed = true;
+    }
+}
+
+void RaceServer::startRace() {
+    std::uint32_t seed = std::random_device{}();
+    schedule.reset(seed);
+    racing = true;
+
+    RaceMessage start;
+    start.type = RaceStart;
+    start.seed = seed;
+    for (auto &entry : clients) {
+        Client &client = entry.second;
+        if (client.joined && !client.closed) {
+            client.racing = true;
+            client.finished = false;
+            client.score.points = 0;
+            client.score.lives = 0;
+            client.scoreChanged = false;
+            encodeRaceMessage(start, client.out);
+        }
+    }
+    std::cout << "Race started with seed " << seed << std::endl;
+}
+
+void RaceServer::tick(float dt) {
+    broadcast.clear();
+
+    if (!racing) {
+        int ready = 0;
+        for (const auto &entry : clients) {
+            ready += entry.second.joined && !entry.second.closed;
+        }
+        if (ready >= playersPerRace) {
+            startRace();
+        }
+    } else {
+        schedule.advance(dt);
+        while (schedule.isDue()) {
+            RaceMessage spawn;
+            spawn.type = RaceSpawn;
+            spawn.spawn = schedule.take(corpusSize);
+            encodeRaceMessage(spawn, broadcast);
+        }
+
+        bool anyoneAlive = false;
+        for (auto &entry : clients) {
+            Client &client = entry.second;
+            if (!client.racing || client.closed) {
+                continue;
+            }
+            if (client.scoreChanged) {
+                RaceMessage scores;
+                scores.type = RaceScores;
+                scores.score = client.score;
+                encodeRaceMessage(scores, broadcast);
+                client.scoreChanged = false;
+            }
+            anyoneAlive = anyoneAlive || !client.finished;
+        }
+        if (!anyoneAlive) {
+            RaceMessage finish;
+            finish.type = RaceFinish;
+            encodeRaceMessage(finish, broadcast);
+            racing = false;
+        }
+    }
+
+    for (auto &entry : clients) {
+        Client &client = entry.second;
+        if (client.closed) {
+            continue;
+        }
+        if (client.racing) {
+            client.out.insert(client.out.end(), broadcast.begin(), broadcast.end());
+            if (!racing) {
+                client.racing = false;
+                client.joined = false;
+            }
+        }
+        if (!client.out.empty() && !client.waitingToWrite) {
+            flush(client);
+        }
+    }
+}
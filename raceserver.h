@@ -0,0 +1,62 @@
+#ifndef PROJECT_RACESERVER_H
+#define PROJECT_RACESERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "raceprotocol.h"
+#include "spawnschedule.h"
+
+// Single-threaded, non-blocking race server built on epoll.
+// Once playersPerRace clients have said hello, it starts a race with a fresh seed, drives the
+// shared SpawnSchedule and relays score changes. All output for a tick is batched into one send per client.
+class RaceServer {
+public:
+    RaceServer(std::string category, std::size_t corpusSize, int playersPerRace);
+    ~RaceServer();
+
+    bool listen(std::uint16_t port);
+    void run();
+    void stop();
+    std::uint16_t getPort() const;
+
+private:
+    struct Client {
+        int fd = -1;
+        std::uint16_t playerId = 0;
+        bool joined = false;
+        bool racing = false;
+        bool finished = false;
+        bool scoreChanged = false;
+        bool waitingToWrite = false;
+        bool closed = false;
+        RaceStanding score;
+        std::vector<std::uint8_t> in;
+        std::vector<std::uint8_t> out;
+    };
+
+    void acceptClients();
+    void readClient(Client &client);
+    void handleMessage(Client &client, const RaceMessage &message);
+    void flush(Client &client);
+    void closeClient(Client &client);
+    void tick(float dt);
+    void startRace();
+
+    std::string category;
+    std::size_t corpusSize;
+    int playersPerRace;
+    int listenFd = -1;
+    int epollFd = -1;
+    std::uint16_t port = 0;
+    std::uint16_t nextPlayerId = 1;
+    std::unordered_map<int, Client> clients;
+    SpawnSchedule schedule;
+    bool racing = false;
+    std::vector<std::uint8_t> broadcast;
+    std::atomic<bool> stopping{false};
+};
+
+#endif
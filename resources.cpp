@@ -0,0 +1,82 @@
+#include "resources.h"
+#include "embeddedassets.h"
+#include "trace.h"
+#include <iostream>
+#include <string>
+
+namespace {
+    // Embedded copies win, so a self-contained build never depends on the working directory.
+    template <typename Resource>
+    bool loadAsset(Resource &resource, const std::string &name) {
+        if (const EmbeddedAsset *asset = findEmbeddedAsset(name)) {
+            return resource.loadFromMemory(asset->data, asset->size);
+        }
+        return resource.loadFromFile("../assets/" + name);
+    }
+}
+
+bool Resources::load() {
+    TRACE_ZONE("Resources::load");
+    bool loaded = loadBackground();
+    for (int font = 0; font < FontCount; ++font) {
+        loaded = loadFont(font) && loaded;
+    }
+    if (!loaded) {
+        std::cerr << "Failed to load resources." << std::endl;
+    }
+    return loaded;
+}
+
+bool Resources::loadFor(int font) {
+    TRACE_ZONE("Resources::loadFor");
+    if (!loadBackground() || !loadFont(font)) {
+        std::cerr << "Failed to load resources." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+sf::Font &Resources::getFont(int font) {
+    switch (font) {
+        case Roboto:
+            return fontRoboto;
+        case Horror:
+            return fontHorror;
+        case Bold:
+            return fontBold;
+        default:
+            return fontTNR;
+    }
+}
+
+int Resources::getFontChoice(const sf::Font &font) const {
+    if (&font == &fontRoboto) {
+        return Roboto;
+    }
+    if (&font == &fontHorror) {
+        return Horror;
+    }
+    if (&font == &fontBold) {
+        return Bold;
+    }
+    return TimesNewRoman;
+}
+
+// A font that is already loaded is never reloaded, since texts may be drawing with it.
+bool Resources::loadFont(int font) {
+    static const char *const files[FontCount] = {"TimesNewRoman.ttf", "Roboto.ttf", "Horror.ttf", "Bold.ttf"};
+    if (font < 0 || font >= FontCount) {
+        font = TimesNewRoman;
+    }
+    if (!fontLoaded[font]) {
+        fontLoaded[font] = loadAsset(getFont(font), files[font]);
+    }
+    return fontLoaded[font];
+}
+
+bool Resources::loadBackground() {
+    if (!backgroundLoaded) {
+        backgroundLoaded = loadAsset(background, "forest.png");
+    }
+    return backgroundLoaded;
+}
@@ -0,0 +1,29 @@
+#ifndef PROJECT_RESOURCES_H
+#define PROJECT_RESOURCES_H
+
+#include <SFML/Graphics.hpp>
+
+// Fonts and textures shared by every scene, loaded once for the single window.
+struct Resources {
+    // Fonts in the order the font menus list them.
+    enum FontChoice { TimesNewRoman, Roboto, Horror, Bold, FontCount };
+
+    sf::Font fontTNR, fontBold, fontHorror, fontRoboto;
+    sf::Texture background;
+
+    // Loads whatever loadFor() has not loaded yet.
+    bool load();
+    // Loads only the background and one font, so a saved game can resume without waiting for the rest.
+    bool loadFor(int font);
+    sf::Font &getFont(int font);
+    int getFontChoice(const sf::Font &font) const;
+
+private:
+    bool fontLoaded[FontCount] = {};
+    bool backgroundLoaded = false;
+
+    bool loadFont(int font);
+    bool loadBackground();
+};
+
+#endif
@@ -0,0 +1,308 @@
+#include "savegame.h"
+#include "byteorder.h"
+#include "trace.h"
+#include <algorithm>
+#include <bit>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+    const char magic[] = {'M', 'T', 'S', 'G'};
+    constexpr std::uint8_t version = 1;
+
+    void putFloat(std::vector<std::uint8_t> &out, float value) {
+        put32(out, std::bit_cast<std::uint32_t>(value));
+    }
+
+    void putText(std::vector<std::uint8_t> &out, const sf::String &text) {
+        std::size_t length = std::min<std::size_t>(text.getSize(), 0xFFFF);
+        put16(out, static_cast<std::uint16_t>(length));
+        for (std::size_t i = 0; i < length; ++i) {
+            put32(out, text[i]);
+        }
+    }
+
+    std::uint32_t checksum(const std::uint8_t *data, std::size_t size) {
+        std::uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    // Reads fields front to back; once a read runs past the end every later one fails too.
+    class Reader {
+    public:
+        Reader(const std::uint8_t *data, std::size_t size) : data(data), size(size) {}
+
+        bool ok() const { return good; }
+        bool atEnd() const { return offset == size; }
+
+        std::uint8_t get8() {
+            return take(1) ? data[offset - 1] : 0;
+        }
+
+        std::uint16_t get16() {
+            return take(2) ? read16(data + offset - 2) : 0;
+        }
+
+        std::uint32_t get32() {
+            return take(4) ? read32(data + offset - 4) : 0;
+        }
+
+        std::uint64_t get64() {
+            std::uint64_t low = get32();
+            return low | static_cast<std::uint64_t>(get32()) << 32;
+        }
+
+        float getFloat() {
+            return std::bit_cast<float>(get32());
+        }
+
+        void getText(sf::String &text) {
+            text.clear();
+            std::uint16_t length = get16();
+            for (std::uint16_t i = 0; i < length && good; ++i) {
+                text += get32();
+            }
+        }
+
+        void getBytes(std::string &bytes, std::size_t count) {
+            if (take(count)) {
+                bytes.assign(data + offset - count, data + offset);
+            }
+        }
+
+    private:
+        bool take(std::size_t count) {
+            if (!good || size - offset < count) {
+                good = false;
+                return false;
+            }
+            offset += count;
+            return true;
+        }
+
+        const std::uint8_t *data;
+        std::size_t size;
+        std::size_t offset = 0;
+        bool good = true;
+    };
+
+    bool writeFile(const std::string &filename, const std::vector<std::uint8_t> &bytes) {
+        std::string temporary = filename + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+                return false;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, filename, error);
+        return !error;
+    }
+}
+
+void encodeSavedGame(const SavedGame &game, std::vector<std::uint8_t> &out) {
+    out.clear();
+    out.insert(out.end(), std::begin(magic), std::end(magic));
+    out.push_back(version);
+    std::size_t categoryLength = std::min<std::size_t>(game.category.size(), 255);
+    out.push_back(static_cast<std::uint8_t>(categoryLength));
+    out.insert(out.end(), game.category.begin(), game.category.begin() + categoryLength);
+    out.push_back(static_cast<std::uint8_t>(game.font));
+    put16(out, static_cast<std::uint16_t>(game.fontSize));
+
+    const Simulation::State &state = game.state;
+    putFloat(out, state.config.width);
+    putFloat(out, state.config.height);
+    putFloat(out, state.config.charWidth);
+    putFloat(out, state.config.lineHeight);
+    put32(out, static_cast<std::uint32_t>(state.config.lives));
+    out.push_back(state.config.scheduledSpawns ? 1 : 0);
+
+    put32(out, state.schedule.seed);
+    put64(out, state.schedule.draws);
+    putFloat(out, state.schedule.timeElapsed);
+    putFloat(out, state.schedule.spawnInterval);
+    putFloat(out, state.schedule.speed);
+    put32(out, static_cast<std::uint32_t>(state.schedule.wordCount));
+
+    put64(out, state.corpusHash);
+    put32(out, static_cast<std::uint32_t>(state.points));
+    put32(out, static_cast<std::uint32_t>(state.lives));
+    out.push_back(state.over ? 1 : 0);
+    putText(out, state.typedWord);
+
+    std::size_t streamedCount = std::min<std::size_t>(state.streamedWords.size(), 0xFFFF);
+    put16(out, static_cast<std::uint16_t>(streamedCount));
+    for (std::size_t i = 0; i < streamedCount; ++i) {
+        putText(out, state.streamedWords[i]);
+    }
+    std::size_t wordCount = std::min<std::size_t>(state.words.size(), 0xFFFF);
+    put16(out, static_cast<std::uint16_t>(wordCount));
+    for (std::size_t i = 0; i < wordCount; ++i) {
+        const Simulation::ActiveWord &word = state.words[i];
+        put32(out, word.wordId);
+        put32(out, word.typedLength);
+        putFloat(out, word.x);
+        putFloat(out, word.y);
+    }
+    put32(out, checksum(out.data(), out.size()));
+}
+
+bool decodeSavedGame(const std::uint8_t *data, std::size_t size, SavedGame &game) {
+    if (size < sizeof(magic) + 1 + 4 || !std::equal(std::begin(magic), std::end(magic), data) ||
+        data[sizeof(magic)] != version) {
+        return false;
+    }
+    Reader checksumReader(data + size - 4, 4);
+    if (checksumReader.get32() != checksum(data, size - 4)) {
+        return false;
+    }
+
+    Reader in(data + sizeof(magic) + 1, size - sizeof(magic) - 1 - 4);
+    in.getBytes(game.category, in.get8());
+    game.font = in.get8();
+    game.fontSize = in.get16();
+
+    Simulation::State &state = game.state;
+    state.config.width = in.getFloat();
+    state.config.height = in.getFloat();
+    state.config.charWidth = in.getFloat();
+    state.config.lineHeight = in.getFloat();
+    state.config.lives = static_cast<std::int32_t>(in.get32());
+    state.config.scheduledSpawns = in.get8() != 0;
+
+    state.schedule.seed = in.get32();
+    state.schedule.draws = in.get64();
+    state.schedule.timeElapsed = in.getFloat();
+    state.schedule.spawnInterval = in.getFloat();
+    state.schedule.speed = in.getFloat();
+    state.schedule.wordCount = static_cast<std::int32_t>(in.get32());
+
+    state.corpusHash = in.get64();
+    state.points = static_cast<std::int32_t>(in.get32());
+    state.lives = static_cast<std::int32_t>(in.get32());
+    state.over = in.get8() != 0;
+    in.getText(state.typedWord);
+
+    state.streamedWords.assign(in.get16(), sf::String());
+    for (auto &word : state.streamedWords) {
+        in.getText(word);
+    }
+    state.words.assign(in.get16(), Simulation::ActiveWord());
+    for (auto &word : state.words) {
+        word.wordId = in.get32();
+        word.typedLength = in.get32();
+        word.x = in.getFloat();
+        word.y = in.getFloat();
+    }
+    return in.ok() && in.atEnd();
+}
+
+bool readSavedGame(const std::string &filename, SavedGame &game) {
+    TRACE_ZONE("readSavedGame");
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!decodeSavedGame(bytes.data(), bytes.size(), game)) {
+        std::cerr << "Ignoring damaged saved game " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::size_t savedGameCapacity(std::size_t words) {
+    const std::size_t maxText = 2 + 4 * WordIndex::maxLength;
+    std::size_t header = sizeof(magic) + 1 + 1 + 255 + 1 + 2;
+    std::size_t config = 4 * 4 + 4 + 1;
+    std::size_t schedule = 4 + 8 + 3 * 4 + 4;
+    std::size_t score = 8 + 4 + 4 + 1;
+    // The simulation reserves room for a typed word twice the longest word; longer ones are rare enough to grow.
+    std::size_t typed = 2 + 4 * 2 * WordIndex::maxLength;
+    // Each word is 16 bytes, plus its text if it came from a streamed file.
+    return header + config + schedule + score + typed + 2 + 2 + words * (16 + maxText) + 4;
+}
+
+SavedGameWriter::~SavedGameWriter() {
+    stop();
+}
+
+void SavedGameWriter::start(const std::string &name) {
+    stop();
+    filename = name;
+    stopping = false;
+    writer = std::thread(&SavedGameWriter::run, this);
+}
+
+void SavedGameWriter::stop() {
+    if (!writer.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+bool SavedGameWriter::isRunning() const {
+    return writer.joinable();
+}
+
+void SavedGameWriter::submit(std::vector<std::uint8_t> &bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(pending, bytes);
+        hasPending = true;
+        discardPending = false;
+    }
+    wake.notify_one();
+}
+
+void SavedGameWriter::discard() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        hasPending = false;
+        discardPending = true;
+    }
+    wake.notify_one();
+}
+
+void SavedGameWriter::reserve(std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.reserve(bytes);
+    writing.reserve(bytes);
+}
+
+void SavedGameWriter::run() {
+    TRACE_THREAD("saver");
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || hasPending || discardPending; });
+        if (hasPending) {
+            std::swap(writing, pending);
+            hasPending = false;
+            lock.unlock();
+            TRACE_ZONE("SavedGameWriter::write");
+            if (!writeFile(filename, writing)) {
+                std::cerr << "Failed to save game to " << filename << std::endl;
+            }
+            lock.lock();
+        } else if (discardPending) {
+            discardPending = false;
+            lock.unlock();
+            std::error_code error;
+            std::filesystem::remove(filename, error);
+            lock.lock();
+        } else {
+            return;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef PROJECT_SAVEGAME_H
+#define PROJECT_SAVEGAME_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "simulation.h"
+
+// A suspended game: what the simulation needs to carry on, plus what the player had picked around it.
+// The file is little-endian binary:
+//   "MTSG" u8 version
+//   u8 length, category bytes; u8 font; u16 font size
+//   config    f32 width, height, charWidth, lineHeight; i32 lives; u8 scheduledSpawns
+//   schedule  u32 seed; u64 draws; f32 timeElapsed, spawnInterval, speed; i32 wordCount
+//   u64 corpus hash; i32 points; i32 lives; u8 over
+//   u16 length, u32 characters of the typed word
+//   u16 count, then per streamed word u16 length, u32 characters
+//   u16 count, then per word on screen u32 wordId, u32 typedLength, f32 x, f32 y
+//   u32 FNV-1a checksum of everything before it
+struct SavedGame {
+    std::string category;
+    int font = 0;
+    int fontSize = 30;
+    Simulation::State state;
+};
+
+void encodeSavedGame(const SavedGame &game, std::vector<std::uint8_t> &out);
+bool decodeSavedGame(const std::uint8_t *data, std::size_t size, SavedGame &game);
+bool readSavedGame(const std::string &filename, SavedGame &game);
+// The most bytes a save with this many words on screen takes, for words of up to WordIndex::maxLength characters.
+std::size_t savedGameCapacity(std::size_t words);
+
+// Writes saved games on its own thread, so taking one costs the game only the encoding.
+// Each write goes to a temporary file renamed over the last save, so a crash mid-write keeps the old one.
+class SavedGameWriter {
+public:
+    ~SavedGameWriter();
+
+    void start(const std::string &filename);
+    // Writes anything still pending before returning.
+    void stop();
+    bool isRunning() const;
+    // Takes the contents of bytes, leaving a buffer to encode the next save into. A save still waiting is replaced.
+    void submit(std::vector<std::uint8_t> &bytes);
+    // Deletes the save, for a game that has ended.
+    void discard();
+    // Gives the buffers saves pass through room for this many bytes, so submitting one never allocates.
+    void reserve(std::size_t bytes);
+
+private:
+    void run();
+
+    std::string filename;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::uint8_t> pending;
+    std::vector<std::uint8_t> writing;
+    bool hasPending = false;
+    bool discardPending = false;
+    bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include "scene.h"
+#include "alloctracker.h"
+#include "trace.h"
+#include <chrono>
+#include <thread>
+
+SceneManager::SceneManager(sf::RenderWindow &window) : window(window) {}
+
+void SceneManager::push(Scene &scene) {
+    pending.push_back(&scene);
+}
+
+void SceneManager::pop() {
+    ++pendingPops;
+}
+
+sf::RenderWindow &SceneManager::getWindow() {
+    return window;
+}
+
+void SceneManager::applyTransitions() {
+    for (; pendingPops > 0 && !scenes.empty(); --pendingPops) {
+        scenes.pop_back();
+    }
+    pendingPops = 0;
+    for (Scene *scene : pending) {
+        scenes.push_back(scene);
+        scene->enter();
+    }
+    pending.clear();
+    current = scenes.empty() ? nullptr : scenes.back();
+}
+
+void SceneManager::run() {
+    applyTransitions();
+    running = current != nullptr;
+    window.setActive(false);
+    std::thread renderer(&SceneManager::renderLoop, this);
+
+    TRACE_THREAD("events");
+    ALLOC_THREAD(AllocInput);
+    sf::Event event;
+    while (running) {
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) {
+                running = false;
+                break;
+            }
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F9) {
+                TRACE_EXPORT("../assets/trace.json");
+                continue;
+            }
+            Scene *scene = current;
+            if (scene && scene->handleInputAsync(event)) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(frameMutex);
+            if (scenes.empty()) {
+                break;
+            }
+            scenes.back()->handleInput(event);
+            if (scenes.back()->isClosing()) {
+                running = false;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    renderer.join();
+    window.close();
+    TRACE_EXPORT("../assets/trace.json");
+    ALLOC_SUMMARY();
+}
+
+void SceneManager::renderLoop() {
+    window.setActive(true);
+    TRACE_THREAD("render");
+    while (running) {
+        TRACE_ZONE("SceneManager::frame");
+        [[maybe_unused]] bool steady = false;
+        {
+            TRACE_ZONE("SceneManager::updateAndRender");
+            std::lock_guard<std::mutex> lock(frameMutex);
+            applyTransitions();
+            if (scenes.empty() || scenes.back()->isClosing()) {
+                running = false;
+                break;
+            }
+            {
+                ALLOC_PHASE(AllocUpdate);
+                scenes.back()->update();
+            }
+            {
+                ALLOC_PHASE(AllocRender);
+                window.clear();
+                scenes.back()->render();
+            }
+            steady = scenes.back()->isSteady();
+        }
+        {
+            TRACE_ZONE("SceneManager::display");
+            ALLOC_PHASE(AllocDisplay);
+            window.display();
+        }
+        ALLOC_FRAME_END(steady);
+    }
+    window.setActive(false);
+}
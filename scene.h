@@ -0,0 +1,52 @@
+#ifndef PROJECT_SCENE_H
+#define PROJECT_SCENE_H
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+class Scene {
+public:
+    virtual ~Scene() = default;
+    virtual void enter() {}
+    // Called on the input thread without the frame lock; return true if the event was consumed.
+    virtual bool handleInputAsync(const sf::Event &) { return false; }
+    virtual void handleInput(const sf::Event &event) = 0;
+    virtual void update() {}
+    virtual void render() = 0;
+    // True while frames should not touch the heap, e.g. a game in progress.
+    virtual bool isSteady() const { return false; }
+    bool isClosing() const { return closing; }
+
+protected:
+    std::atomic<bool> closing{false};
+};
+
+// Runs the scene on top of the stack in the one window every scene shares.
+// Events are polled on the calling thread and frames are drawn on a render thread,
+// so a slow display() never holds up input. Both sides take the frame lock around
+// scene calls, except handleInputAsync(). push() and pop() take effect between frames.
+class SceneManager {
+public:
+    explicit SceneManager(sf::RenderWindow &window);
+    void push(Scene &scene);
+    void pop();
+    void run();
+    sf::RenderWindow &getWindow();
+
+private:
+    void renderLoop();
+    void applyTransitions();
+
+    sf::RenderWindow &window;
+    std::vector<Scene *> scenes;
+    std::vector<Scene *> pending;
+    int pendingPops = 0;
+
+    std::mutex frameMutex;
+    std::atomic<Scene *> current{nullptr};
+    std::atomic<bool> running{false};
+};
+
+#endif
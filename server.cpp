@@ -0,0 +1,51 @@
+#include "raceserver.h"
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+    RaceServer *activeServer = nullptr;
+
+    void handleSignal(int) {
+        if (activeServer) {
+            activeServer->stop();
+        }
+    }
+
+    // Counts words the same way Game::uploadWordsFromFile reads them, so indices line up with the clients.
+    std::size_t countWords(const std::string &filename) {
+        std::ifstream file(filename);
+        std::size_t count = 0;
+        std::string word;
+        while (file >> word) {
+            ++count;
+        }
+        return count;
+    }
+}
+
+// Usage: monkeytyper_server [port] [category] [players per race]
+int main(int argc, char *argv[]) {
+    std::uint16_t port = argc > 1 ? static_cast<std::uint16_t>(std::stoi(argv[1])) : 5555;
+    std::string category = argc > 2 ? argv[2] : "Mix";
+    int players = argc > 3 ? std::stoi(argv[3]) : 2;
+
+    std::size_t corpusSize = countWords("../assets/" + category + ".txt");
+    if (corpusSize == 0) {
+        std::cerr << "No words loaded from file ../assets/" << category << ".txt" << std::endl;
+        return 1;
+    }
+
+    RaceServer server(category, corpusSize, players);
+    if (!server.listen(port)) {
+        return 1;
+    }
+    activeServer = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    std::cout << "Race server on port " << server.getPort() << ", " << category << " (" << corpusSize << " words), "
+              << players << " players per race" << std::endl;
+    server.run();
+    return 0;
+}
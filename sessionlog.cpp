@@ -0,0 +1,153 @@
+#include "sessionlog.h"
+#include <iomanip>
+#include <limits>
+
+namespace {
+    constexpr std::size_t maxAdvances = 1 << 16;
+    // About ten minutes of fast typing, so recording keys does not allocate during most games.
+    constexpr std::size_t reservedKeys = 1 << 14;
+}
+
+void SessionRecorder::begin(const SessionHeader &newHeader) {
+    header = newHeader;
+    keys.clear();
+    keys.reserve(reservedKeys);
+    steps = 0;
+    recording = true;
+}
+
+void SessionRecorder::cancel() {
+    recording = false;
+    keys.clear();
+    steps = 0;
+}
+
+bool SessionRecorder::isRecording() const {
+    return recording;
+}
+
+void SessionRecorder::recordKey(sf::Uint32 key) {
+    if (recording) {
+        keys.push_back({steps, key});
+    }
+}
+
+void SessionRecorder::recordStep() {
+    if (recording) {
+        ++steps;
+    }
+}
+
+bool SessionRecorder::save(const std::string &filename, int points) const {
+    if (!recording) {
+        return false;
+    }
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    const Simulation::Config &config = header.config;
+    file << "monkeytyper-session 2\n"
+         << "seed " << header.seed << "\n"
+         << "category " << header.category << "\n"
+         << "corpus " << std::hex << header.corpusHash << std::dec << "\n"
+         << std::setprecision(std::numeric_limits<float>::max_digits10)
+         << "config " << config.width << " " << config.height << " " << config.charWidth << " "
+         << config.lineHeight << " " << config.lives << "\n"
+         << "advances " << header.advances.size();
+    for (const auto &advance : header.advances) {
+        file << " " << advance.first << " " << advance.second;
+    }
+    file << "\nkeys\n";
+    for (const auto &key : keys) {
+        file << key.step << " " << key.key << "\n";
+    }
+    file << "end " << steps << " " << points << "\n";
+    return static_cast<bool>(file);
+}
+
+bool SessionReader::open(const std::string &filename) {
+    file.open(filename);
+    if (!file.is_open()) {
+        error = "cannot open file";
+        return false;
+    }
+    std::string label;
+    int version = 0;
+    Simulation::Config &config = header.config;
+    if (!(file >> label >> version) || label != "monkeytyper-session" || version != 2 ||
+        !(file >> label >> header.seed) || label != "seed" ||
+        !(file >> label >> header.category) || label != "category" ||
+        !(file >> label >> std::hex >> header.corpusHash >> std::dec) || label != "corpus" ||
+        !(file >> label >> config.width >> config.height >> config.charWidth >> config.lineHeight >> config.lives) || label != "config") {
+        error = "malformed header";
+        return false;
+    }
+    std::size_t count = 0;
+    if (!(file >> label >> count) || label != "advances" || count > maxAdvances) {
+        error = "malformed header";
+        return false;
+    }
+    header.advances.resize(count);
+    for (auto &advance : header.advances) {
+        if (!(file >> advance.first >> advance.second)) {
+            error = "malformed header";
+            return false;
+        }
+    }
+    if (!(file >> label) || label != "keys") {
+        error = "malformed header";
+        return false;
+    }
+    return true;
+}
+
+const SessionHeader &SessionReader::getHeader() const {
+    return header;
+}
+
+bool SessionReader::nextKey(SessionKey &key) {
+    if (complete || !error.empty()) {
+        return false;
+    }
+    std::string first;
+    if (!(file >> first)) {
+        error = "missing end line";
+        return false;
+    }
+    if (first == "end") {
+        if (!(file >> steps >> points)) {
+            error = "malformed end line";
+            return false;
+        }
+        complete = true;
+        return false;
+    }
+    try {
+        key.step = std::stoull(first);
+    } catch (const std::exception &) {
+        error = "malformed key line";
+        return false;
+    }
+    if (!(file >> key.key)) {
+        error = "malformed key line";
+        return false;
+    }
+    return true;
+}
+
+bool SessionReader::isComplete() const {
+    return complete;
+}
+
+std::uint64_t SessionReader::getSteps() const {
+    return steps;
+}
+
+int SessionReader::getPoints() const {
+    return points;
+}
+
+const std::string &SessionReader::getError() const {
+    return error;
+}
@@ -0,0 +1,73 @@
+#ifndef PROJECT_SESSIONLOG_H
+#define PROJECT_SESSIONLOG_H
+
+#include <SFML/System/String.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "simulation.h"
+
+// A recorded game is everything needed to replay it: the seed, the corpus, the simulation config
+// and every keystroke with the fixed step it was applied before. The file is plain text:
+//   monkeytyper-session 2
+//   seed <seed>
+//   category <name>
+//   corpus <hash of the word list>
+//   config <width> <height> <charWidth> <lineHeight> <lives>
+//   advances <count> <code point> <advance> ...
+//   keys
+//   <step> <code point>
+//   ...
+//   end <steps> <claimed points>
+struct SessionHeader {
+    std::uint32_t seed = 0;
+    std::string category;
+    std::uint64_t corpusHash = 0;
+    Simulation::Config config;
+    std::vector<WordIndex::Advance> advances;
+};
+
+struct SessionKey {
+    std::uint64_t step = 0;
+    sf::Uint32 key = 0;
+};
+
+class SessionRecorder {
+public:
+    void begin(const SessionHeader &newHeader);
+    void cancel();
+    bool isRecording() const;
+    void recordKey(sf::Uint32 key);
+    void recordStep();
+    bool save(const std::string &filename, int points) const;
+
+private:
+    bool recording = false;
+    SessionHeader header;
+    std::vector<SessionKey> keys;
+    std::uint64_t steps = 0;
+};
+
+// Reads a session file front to back without loading the keystrokes into memory.
+class SessionReader {
+public:
+    bool open(const std::string &filename);
+    const SessionHeader &getHeader() const;
+    // Returns false once the end line is reached; getSteps() and getPoints() are valid after that.
+    bool nextKey(SessionKey &key);
+    bool isComplete() const;
+    std::uint64_t getSteps() const;
+    int getPoints() const;
+    const std::string &getError() const;
+
+private:
+    std::ifstream file;
+    SessionHeader header;
+    bool complete = false;
+    std::uint64_t steps = 0;
+    int points = 0;
+    std::string error;
+};
+
+#endif
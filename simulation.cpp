@@ -0,0 +1,325 @@
+#include "simulation.h"
+#include "stringutil.h"
+#include "trace.h"
+#include <algorithm>
+
+namespace {
+    // No word wider than this share of the screen is spawned while narrower ones are available.
+    constexpr float maxWordWidthShare = 0.5f;
+
+    // sf::String has no reserve(); taking a copy of a long string and clearing it leaves the capacity
+    // behind, so typing a word never grows the typed text once a game is under way.
+    void reserveTypedText(sf::String &text) {
+        if (!text.isEmpty()) {
+            return;
+        }
+        sf::String room;
+        for (std::size_t i = 0; i < 2 * WordIndex::maxLength; ++i) {
+            room += static_cast<sf::Uint32>('W');
+        }
+        text = room;
+        text.clear();
+    }
+
+    const sf::String noWord;
+}
+
+Simulation::Snapshot::Snapshot() {
+    words.reserve(reservedWords);
+    reserveTypedText(typedWord);
+}
+
+Simulation::State::State() {
+    words.reserve(reservedWords);
+    reserveTypedText(typedWord);
+}
+
+const sf::String &Simulation::Snapshot::getWordText(const ActiveWord &word) const {
+    if (word.wordId & streamedWordBit) {
+        std::uint32_t slot = word.wordId & ~streamedWordBit;
+        return slot < streamedWords.size() ? streamedWords[slot] : noWord;
+    }
+    return corpus && word.wordId < corpus->words.size() ? corpus->words[word.wordId] : noWord;
+}
+
+void Simulation::setWordSource(std::shared_ptr<const Corpus> newCorpus, WordStream *stream) {
+    corpus = std::move(newCorpus);
+    wordStream = stream;
+}
+
+void Simulation::swapCorpus(std::shared_ptr<const Corpus> newCorpus) {
+    for (auto &word : wordsOnScreen) {
+        if (!(word.wordId & streamedWordBit)) {
+            sf::String text = getWordText(word.wordId);
+            word.wordId = internStreamedWord(text);
+        }
+    }
+    corpus = std::move(newCorpus);
+}
+
+void Simulation::reset(const Config &newConfig, unsigned seed) {
+    config = newConfig;
+    schedule.reset(seed);
+    wordsOnScreen.clear();
+    wordsOnScreen.reserve(reservedWords);
+    reserveTypedText(typedWord);
+    streamedWords.clear();
+    streamedGenerations.clear();
+    freeStreamedSlots.clear();
+    typedWord.clear();
+    points = 0;
+    lives = config.lives;
+    over = false;
+}
+
+void Simulation::step(float dt) {
+    TRACE_ZONE("Simulation::step");
+    if (over) {
+        return;
+    }
+    updateWords(dt);
+
+    if (config.scheduledSpawns && schedule.isDue() && lives > 0) {
+        std::size_t minLength = schedule.getMinLength();
+        std::size_t maxLength = schedule.getMaxLength();
+        SpawnPick pick = schedule.take(corpus ? corpus->words.size() : 0);
+        if (corpus && !corpus->index.isEmpty()) {
+            pick.wordIndex = corpus->index.draw(pick.wordIndex, minLength, maxLength, config.width * maxWordWidthShare);
+        }
+        spawnWord(pick);
+    }
+    schedule.advance(dt);
+    removeOutOfBoundsWords();
+    if (lives <= 0) {
+        over = true;
+        wordsOnScreen.clear();
+    }
+}
+
+void Simulation::typeChar(sf::Uint32 typedChar) {
+    TRACE_ZONE("Simulation::typeChar");
+    if (over) {
+        return;
+    }
+    if (typedChar == '\b') {
+        if (!typedWord.isEmpty()) {
+            typedWord.erase(typedWord.getSize() - 1);
+        }
+    } else if (typedChar == '\r' || typedChar == '\n') {
+        auto wordIter = std::find_if(wordsOnScreen.begin(), wordsOnScreen.end(),
+                                     [this](const ActiveWord &word) {
+                                         return getWordText(word.wordId) == typedWord;
+                                     });
+        if (wordIter != wordsOnScreen.end()) {
+            releaseWord(*wordIter);
+            wordsOnScreen.erase(wordIter);
+            typedWord.clear();
+            points++;
+        }
+    } else if (typedChar >= 32 && typedChar != 127) {
+        typedWord += typedChar;
+    }
+    updateTypedParts();
+}
+
+// Only the matching word furthest to the right shows the typed prefix.
+void Simulation::updateTypedParts() {
+    ActiveWord *closestWord = nullptr;
+    float maxPositionX = -1.0f;
+    for (auto &word : wordsOnScreen) {
+        if (startsWith(getWordText(word.wordId), typedWord) && word.x > maxPositionX) {
+            closestWord = &word;
+            maxPositionX = word.x;
+        }
+    }
+    for (auto &word : wordsOnScreen) {
+        word.typedLength = &word == closestWord ? static_cast<std::uint32_t>(typedWord.getSize()) : 0;
+    }
+}
+
+// Race clients spawn when the server says so. The local schedule still takes the pick,
+// so speed and spawn interval progress exactly as they do on the server.
+void Simulation::spawnFromServer(const SpawnPick &pick) {
+    if (over) {
+        return;
+    }
+    // The server only knows the list's size, so the length band and width cap are applied here, where the
+    // font is known. The local schedule keeps step with the server's, so the band matches a solo game's.
+    std::size_t minLength = schedule.getMinLength();
+    std::size_t maxLength = schedule.getMaxLength();
+    schedule.take(corpus ? corpus->words.size() : 0);
+    SpawnPick banded = pick;
+    if (corpus && !corpus->index.isEmpty()) {
+        banded.wordIndex = corpus->index.draw(pick.wordIndex, minLength, maxLength, config.width * maxWordWidthShare);
+    }
+    spawnWord(banded);
+}
+
+void Simulation::capture(Snapshot &snapshot) const {
+    TRACE_ZONE("Simulation::capture");
+    snapshot.words.assign(wordsOnScreen.begin(), wordsOnScreen.end());
+    snapshot.typedWord = typedWord;
+    snapshot.points = points;
+    snapshot.lives = lives;
+    snapshot.over = over;
+    if (snapshot.corpus != corpus) {
+        snapshot.corpus = corpus;
+    }
+    snapshot.streamedWords.resize(streamedWords.size());
+    snapshot.streamedGenerations.resize(streamedGenerations.size(), 0);
+    for (std::size_t slot = 0; slot < streamedWords.size(); ++slot) {
+        if (snapshot.streamedGenerations[slot] != streamedGenerations[slot]) {
+            snapshot.streamedWords[slot] = streamedWords[slot];
+            snapshot.streamedGenerations[slot] = streamedGenerations[slot];
+        }
+    }
+}
+
+void Simulation::saveState(State &state) const {
+    state.config = config;
+    state.schedule = schedule.getState();
+    state.corpusHash = corpus ? corpus->hash : 0;
+    state.words.assign(wordsOnScreen.begin(), wordsOnScreen.end());
+    state.streamedWords.clear();
+    for (auto &word : state.words) {
+        if (word.wordId & streamedWordBit) {
+            state.streamedWords.push_back(getWordText(word.wordId));
+            word.wordId = static_cast<std::uint32_t>(state.streamedWords.size() - 1) | streamedWordBit;
+        }
+    }
+    state.typedWord = typedWord;
+    state.points = points;
+    state.lives = lives;
+    state.over = over;
+}
+
+bool Simulation::restoreState(const State &state) {
+    std::size_t corpusSize = corpus ? corpus->words.size() : 0;
+    for (const auto &word : state.words) {
+        bool known = word.wordId & streamedWordBit
+                         ? (word.wordId & ~streamedWordBit) < state.streamedWords.size()
+                         : word.wordId < corpusSize && state.corpusHash == corpus->hash;
+        if (!known) {
+            return false;
+        }
+    }
+
+    reset(state.config, state.schedule.seed);
+    schedule.setState(state.schedule);
+    for (ActiveWord word : state.words) {
+        if (word.wordId & streamedWordBit) {
+            sf::String text = state.streamedWords[word.wordId & ~streamedWordBit];
+            word.wordId = internStreamedWord(text);
+        }
+        wordsOnScreen.push_back(word);
+    }
+    typedWord = state.typedWord;
+    points = state.points;
+    lives = state.lives;
+    over = state.over;
+    return true;
+}
+
+void Simulation::finish() {
+    over = true;
+    wordsOnScreen.clear();
+}
+
+bool Simulation::isOver() const {
+    return over;
+}
+
+int Simulation::getPoints() const {
+    return points;
+}
+
+int Simulation::getLives() const {
+    return lives;
+}
+
+const std::vector<Simulation::ActiveWord> &Simulation::getWords() const {
+    return wordsOnScreen;
+}
+
+const sf::String &Simulation::getTypedWord() const {
+    return typedWord;
+}
+
+const sf::String &Simulation::getWordText(std::uint32_t wordId) const {
+    if (wordId & streamedWordBit) {
+        std::uint32_t slot = wordId & ~streamedWordBit;
+        return slot < streamedWords.size() ? streamedWords[slot] : noWord;
+    }
+    return corpus && wordId < corpus->words.size() ? corpus->words[wordId] : noWord;
+}
+
+// Streamed words are kept in reusable slots, so the pool stays as small as the number of words on screen.
+std::uint32_t Simulation::internStreamedWord(sf::String &word) {
+    std::uint32_t slot;
+    if (!freeStreamedSlots.empty()) {
+        slot = freeStreamedSlots.back();
+        freeStreamedSlots.pop_back();
+    } else {
+        slot = static_cast<std::uint32_t>(streamedWords.size());
+        streamedWords.emplace_back();
+        streamedGenerations.push_back(0);
+    }
+    std::swap(streamedWords[slot], word);
+    ++streamedGenerations[slot];
+    return slot | streamedWordBit;
+}
+
+void Simulation::releaseWord(const ActiveWord &word) {
+    if (word.wordId & streamedWordBit) {
+        freeStreamedSlots.push_back(word.wordId & ~streamedWordBit);
+    }
+}
+
+void Simulation::spawnWord(const SpawnPick &pick) {
+    TRACE_ZONE("Simulation::spawnWord");
+    ActiveWord newWord;
+    float width = -1;
+    if (wordStream && wordStream->isOpen()) {
+        if (!wordStream->next(streamScratch)) {
+            return;
+        }
+        newWord.wordId = internStreamedWord(streamScratch);
+    } else if (corpus && pick.wordIndex < corpus->words.size()) {
+        newWord.wordId = pick.wordIndex;
+        if (corpus->index.isMeasured()) {
+            width = corpus->index.getWidth(pick.wordIndex);
+        }
+    } else {
+        return;
+    }
+
+    float maxY = config.height - config.lineHeight - 130;
+    float minY = 0.0f;
+    float scorePanelHeight = 100.0f;
+    int range = std::max(static_cast<int>(maxY - minY - scorePanelHeight), 1);
+    if (width < 0) {
+        width = config.charWidth * static_cast<float>(getWordText(newWord.wordId).getSize());
+    }
+    newWord.x = -width;
+    newWord.y = static_cast<float>(pick.yFraction * range / 65536) + minY;
+
+    wordsOnScreen.push_back(newWord);
+}
+
+void Simulation::updateWords(float dt) {
+    for (auto &word : wordsOnScreen) {
+        word.x += schedule.getSpeed() * dt;
+    }
+}
+
+void Simulation::removeOutOfBoundsWords() {
+    wordsOnScreen.erase(std::remove_if(wordsOnScreen.begin(), wordsOnScreen.end(),
+                                       [this](const ActiveWord &word) {
+                                           if (word.x > config.width) {
+                                               releaseWord(word);
+                                               --lives;
+                                               return true;
+                                           }
+                                           return false;
+                                       }), wordsOnScreen.end());
+}
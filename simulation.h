@@ -0,0 +1,121 @@
+#ifndef PROJECT_SIMULATION_H
+#define PROJECT_SIMULATION_H
+
+#include <SFML/System/String.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "wordstream.h"
+#include "corpus.h"
+#include "spawnschedule.h"
+#include "raceprotocol.h"
+
+// The game rules without any rendering: spawning, moving and matching words, score and lives.
+class Simulation {
+public:
+    struct Config {
+        float width = 1200;
+        float height = 800;
+        // Used for words without a measured width, such as those from a streamed word file.
+        float charWidth = 15;
+        float lineHeight = 30;
+        int lives = 5;
+        bool scheduledSpawns = true;
+    };
+
+    // Recorded sessions are stepped at this fixed rate so a replay lands on the same score.
+    static constexpr float stepSeconds = 1.0f / 120.0f;
+    // Enough for any screen of words, so spawning never grows the word vectors mid-game.
+    static constexpr std::size_t reservedWords = 128;
+
+    // Words on screen refer to their text by id instead of holding a copy. Ids below streamedWordBit are
+    // corpus indices; the rest name a slot holding a word that came from a streamed word file.
+    static constexpr std::uint32_t streamedWordBit = 0x80000000u;
+
+    struct ActiveWord {
+        std::uint32_t wordId = 0;
+        std::uint32_t typedLength = 0;
+        float x = 0;
+        float y = 0;
+    };
+
+    struct Snapshot {
+        Snapshot();
+
+        std::vector<ActiveWord> words;
+        sf::String typedWord;
+        int points = 0;
+        int lives = 0;
+        bool over = false;
+        std::vector<RaceStanding> raceStandings;
+        // The corpus the word ids refer to, and copies of the streamed word slots,
+        // refreshed only when a slot gets a new word.
+        std::shared_ptr<const Corpus> corpus;
+        std::vector<sf::String> streamedWords;
+        std::vector<std::uint32_t> streamedGenerations;
+
+        const sf::String &getWordText(const ActiveWord &word) const;
+    };
+
+    // A game in progress, for saving and resuming it later. Corpus words are kept by index and checked
+    // against corpusHash on restore; streamed words are kept as text, with ids naming entries of streamedWords.
+    struct State {
+        State();
+
+        Config config;
+        SpawnSchedule::State schedule;
+        std::uint64_t corpusHash = 0;
+        std::vector<ActiveWord> words;
+        std::vector<sf::String> streamedWords;
+        sf::String typedWord;
+        int points = 0;
+        int lives = 0;
+        bool over = false;
+    };
+
+    void setWordSource(std::shared_ptr<const Corpus> newCorpus, WordStream *stream);
+    // Switches to a reloaded word list mid-game. Words already on screen keep their text.
+    void swapCorpus(std::shared_ptr<const Corpus> newCorpus);
+    void reset(const Config &newConfig, unsigned seed);
+    void step(float dt);
+    void typeChar(sf::Uint32 typedChar);
+    void spawnFromServer(const SpawnPick &pick);
+    // Ends the game with the score it has, for a race that is over or has lost its server.
+    void finish();
+    void capture(Snapshot &snapshot) const;
+    void saveState(State &state) const;
+    // Fails, leaving the simulation untouched, if the state's corpus words do not belong to the current corpus.
+    bool restoreState(const State &state);
+
+    bool isOver() const;
+    int getPoints() const;
+    int getLives() const;
+    const std::vector<ActiveWord> &getWords() const;
+    const sf::String &getTypedWord() const;
+    const sf::String &getWordText(std::uint32_t wordId) const;
+
+private:
+    void spawnWord(const SpawnPick &pick);
+    void updateWords(float dt);
+    void removeOutOfBoundsWords();
+    void updateTypedParts();
+    std::uint32_t internStreamedWord(sf::String &word);
+    void releaseWord(const ActiveWord &word);
+
+    Config config;
+    SpawnSchedule schedule;
+    std::shared_ptr<const Corpus> corpus;
+    WordStream *wordStream = nullptr;
+
+    std::vector<ActiveWord> wordsOnScreen;
+    std::vector<sf::String> streamedWords;
+    std::vector<std::uint32_t> streamedGenerations;
+    std::vector<std::uint32_t> freeStreamedSlots;
+    sf::String streamScratch;
+    sf::String typedWord;
+    int points = 0;
+    int lives = 5;
+    bool over = false;
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include "spawnschedule.h"
+#include <algorithm>
+
+void SpawnSchedule::reset(std::uint32_t newSeed) {
+    seed = newSeed;
+    rng.seed(seed);
+    draws = 0;
+    timeElapsed = 0;
+    spawnInterval = 2.5f;
+    speed = 100;
+    wordCount = 0;
+}
+
+void SpawnSchedule::advance(float dt) {
+    timeElapsed += dt;
+}
+
+bool SpawnSchedule::isDue() const {
+    return timeElapsed >= spawnInterval;
+}
+
+SpawnPick SpawnSchedule::take(std::size_t corpusSize) {
+    SpawnPick pick;
+    std::uint32_t wordRoll = rng();
+    pick.wordIndex = corpusSize > 0 ? static_cast<std::uint32_t>(wordRoll % corpusSize) : 0;
+    pick.yFraction = static_cast<std::uint16_t>(rng() >> 16);
+    draws += 2;
+
+    timeElapsed = 0;
+    ++wordCount;
+    if (wordCount % 15 == 0) {
+        speed += 10.0f;
+        spawnInterval = std::max(spawnInterval - 0.5f, 0.5f);
+    }
+    return pick;
+}
+
+float SpawnSchedule::getSpeed() const {
+    return speed;
+}
+
+int SpawnSchedule::getWordCount() const {
+    return wordCount;
+}
+
+std::size_t SpawnSchedule::getMinLength() const {
+    return 1 + static_cast<std::size_t>(wordCount / 30);
+}
+
+std::size_t SpawnSchedule::getMaxLength() const {
+    return 6 + 2 * static_cast<std::size_t>(wordCount / 15);
+}
+
+SpawnSchedule::State SpawnSchedule::getState() const {
+    State state;
+    state.seed = seed;
+    state.draws = draws;
+    state.timeElapsed = timeElapsed;
+    state.spawnInterval = spawnInterval;
+    state.speed = speed;
+    state.wordCount = wordCount;
+    return state;
+}
+
+void SpawnSchedule::setState(const State &state) {
+    seed = state.seed;
+    rng.seed(seed);
+    rng.discard(state.draws);
+    draws = state.draws;
+    timeElapsed = state.timeElapsed;
+    spawnInterval = state.spawnInterval;
+    speed = state.speed;
+    wordCount = state.wordCount;
+}
@@ -0,0 +1,50 @@
+#ifndef PROJECT_SPAWNSCHEDULE_H
+#define PROJECT_SPAWNSCHEDULE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+struct SpawnPick {
+    std::uint32_t wordIndex = 0;
+    std::uint16_t yFraction = 0;
+};
+
+// Decides when the next word spawns, which word it is, where it appears and how fast words move.
+// The same seed yields the same sequence on every machine, which race clients rely on.
+class SpawnSchedule {
+public:
+    // Enough to carry on where a schedule left off. The generator is rebuilt by
+    // reseeding it and discarding the numbers it had already drawn.
+    struct State {
+        std::uint32_t seed = 0;
+        std::uint64_t draws = 0;
+        float timeElapsed = 0;
+        float spawnInterval = 2.5f;
+        float speed = 100;
+        int wordCount = 0;
+    };
+
+    void reset(std::uint32_t seed);
+    void advance(float dt);
+    bool isDue() const;
+    SpawnPick take(std::size_t corpusSize);
+    float getSpeed() const;
+    int getWordCount() const;
+    // Word lengths for the next spawn. The band moves toward longer words at the same pace as the speed.
+    std::size_t getMinLength() const;
+    std::size_t getMaxLength() const;
+    State getState() const;
+    void setState(const State &state);
+
+private:
+    std::mt19937 rng;
+    std::uint32_t seed = 0;
+    std::uint64_t draws = 0;
+    float timeElapsed = 0;
+    float spawnInterval = 2.5f;
+    float speed = 100;
+    int wordCount = 0;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef PROJECT_SPSCQUEUE_H
+#define PROJECT_SPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+public:
+    bool push(const T &value) {
+        std::size_t tail = tailIndex.load(std::memory_order_relaxed);
+        std::size_t next = (tail + 1) % Capacity;
+        if (next == headIndex.load(std::memory_order_acquire)) {
+            return false;
+        }
+        items[tail] = value;
+        tailIndex.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &value) {
+        std::size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailIndex.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = items[head];
+        headIndex.store((head + 1) % Capacity, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, Capacity> items{};
+    alignas(64) std::atomic<std::size_t> headIndex{0};
+    alignas(64) std::atomic<std::size_t> tailIndex{0};
+};
+
+#endif
@@ -1,63 +1,49 @@
 #include "start.h"
 #include "game.h"
+#include "trace.h"
 #include <iostream>
 
-Start::Start(Game &game) : window(sf::VideoMode(1200, 800), "MonkeyTyper Start"), fontTNR(), startText(), startButton(), startGame(false), game(game), chosenFont(0) {
+Start::Start(SceneManager &scenes, Game &game, const Resources &resources) : scenes(scenes), window(scenes.getWindow()), fontTNR(resources.fontTNR), fontBold(resources.fontBold), fontHorror(resources.fontHorror), fontRoboto(resources.fontRoboto), backgroundTexture(resources.background), game(game), chosenFont(0) {
     loadResources();
     setupLayout();
 }
-bool Start::update() {
+void Start::enter() {
     selectedTopic = "Mix";
     game.setCategory(selectedTopic);
-    while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
-            else if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    sf::Vector2f mousePos = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
-                    handleClick(mousePos);
-                    if (startGame) {
-                        game.start();
-                        startGame = false;
-                        return true;
-                    }
-                }
-            } else if (event.type == sf::Event::KeyPressed) {
-                if (event.key.code == sf::Keyboard::Add || event.key.code == sf::Keyboard::Equal) {
-                    game.changeFontSize(game.getFontSize() + 1);
-                } else if (event.key.code == sf::Keyboard::Subtract || event.key.code == sf::Keyboard::Hyphen) {
-                    game.changeFontSize(game.getFontSize() - 1);
-                }
-            } else if (event.type == sf::Event::Resized) {
-                sf::FloatRect visibleArea(0, 0, event.size.width, event.size.height);
-                window.setView(sf::View(visibleArea));
-                setupLayout();
-            }
+}
+void Start::handleInput(const sf::Event &event) {
+    TRACE_ZONE("Start::handleInput");
+    if (event.type == sf::Event::MouseButtonPressed) {
+        if (event.mouseButton.button == sf::Mouse::Left) {
+            sf::Vector2f mousePos = window.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
+            handleClick(mousePos);
+        }
+    } else if (event.type == sf::Event::KeyPressed) {
+        if (event.key.code == sf::Keyboard::Add || event.key.code == sf::Keyboard::Equal) {
+            game.changeFontSize(game.getFontSize() + 1);
+        } else if (event.key.code == sf::Keyboard::Subtract || event.key.code == sf::Keyboard::Hyphen) {
+            game.changeFontSize(game.getFontSize() - 1);
         }
-        window.clear();
-        window.draw(backgroundImage);
-        window.draw(startButton);
-        window.draw(startText);
-        window.draw(settingsText);
-        window.draw(resultsButton);
-        window.draw(resultsText);
-
-        displaySettings();
-        window.display();
+    } else if (event.type == sf::Event::Resized) {
+        sf::FloatRect visibleArea(0, 0, event.size.width, event.size.height);
+        window.setView(sf::View(visibleArea));
+        setupLayout();
     }
-    return false;
+}
+void Start::render() {
+    TRACE_ZONE("Start::render");
+    window.draw(backgroundImage);
+    window.draw(startButton);
+    window.draw(startText);
+    window.draw(settingsText);
+    window.draw(resultsButton);
+    window.draw(resultsText);
+
+    displaySettings();
 }
 
 void Start::loadResources() {
-    if (!fontTNR.loadFromFile("../assets/TimesNewRoman.ttf") ||
-        !fontBold.loadFromFile("../assets/Bold.ttf") ||
-        !fontHorror.loadFromFile("../assets/Horror.ttf") ||
-        !fontRoboto.loadFromFile("../assets/Roboto.ttf") ||
-        !backgroundTexture.loadFromFile("../assets/forest.png")) {
-        std::cerr << "Failed to load resources." << std::endl;
-    }
+    TRACE_ZONE("Start::loadResources");
     backgroundImage.setTexture(backgroundTexture);
     startButton.setSize(sf::Vector2f(250, 50));
     startButton.setFillColor(sf::Color::Black);
@@ -101,8 +87,8 @@ void Start::updateElementPositions() {
 
 void Start::handleClick(sf::Vector2f mousePos) {
     if (startButton.getGlobalBounds().contains(mousePos)) {
-        startGame = true;
-        window.close();
+        scenes.pop();
+        scenes.push(game);
     } else if (resultsButton.getGlobalBounds().contains(mousePos)) {
         std::system("open \"../assets/gameResults.txt\"");
     } else {
@@ -150,6 +136,7 @@ void Start::handleTopicSelection(sf::Vector2f mousePos) {
 }
 
 void Start::displaySettings() {
+    TRACE_ZONE("Start::displaySettings");
     const float buttonSpacing = 25.0f;
     float yPos = settingsText.getPosition().y + settingsText.getLocalBounds().height + buttonSpacing * 2;
 
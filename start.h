@@ -5,23 +5,27 @@
 #include <vector>
 #include <string>
 #include <cstdlib>
+#include "resources.h"
+#include "scene.h"
 
 class Game;
 
-class Start {
+class Start : public Scene {
 public:
-    explicit Start(Game &game);
-    bool update();
+    Start(SceneManager &scenes, Game &game, const Resources &resources);
+    void enter() override;
+    void handleInput(const sf::Event &event) override;
+    void render() override;
 
 private:
-    sf::RenderWindow window;
-    sf::Font fontTNR, fontBold, fontHorror, fontRoboto;
+    SceneManager &scenes;
+    sf::RenderWindow &window;
+    const sf::Font &fontTNR, &fontBold, &fontHorror, &fontRoboto;
     sf::Text startText, settingsText, resultsText;
     sf::RectangleShape startButton, settingsButton, resultsButton;
-    sf::Texture backgroundTexture;
+    const sf::Texture &backgroundTexture;
     sf::Sprite backgroundImage;
     Game &game;
-    bool startGame = false;
     std::string selectedTopic;
 
     void handleClick(sf::Vector2f mousePos);
@@ -0,0 +1,11 @@
+#ifndef PROJECT_STRINGUTIL_H
+#define PROJECT_STRINGUTIL_H
+
+#include <SFML/System/String.hpp>
+#include <algorithm>
+
+inline bool startsWith(const sf::String &word, const sf::String &prefix) {
+    return prefix.getSize() <= word.getSize() && std::equal(prefix.begin(), prefix.end(), word.begin());
+}
+
+#endif
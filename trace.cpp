@@ -0,0 +1,201 @@
+#include "trace.h"
+
+#ifdef MONKEYTYPER_TRACING
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    // Fields are relaxed atomics so the exporter may read a slot while its thread rewrites it;
+    // TraceThread's counters tell it afterwards whether it did.
+    struct TraceEvent {
+        std::atomic<const char *> name{nullptr};
+        std::atomic<std::int64_t> start{0};
+        std::atomic<std::int64_t> duration{0};
+    };
+
+    // Each thread records into a fixed ring of its latest events, taken when the thread registers,
+    // so recording never allocates and a long session keeps the most recent stretch of it.
+    // Only the owning thread writes. It bumps begun before touching a slot and written after filling it,
+    // the way a seqlock does, so the exporter can copy the ring at any time and drop whatever was overwritten meanwhile.
+    struct TraceThread {
+        static constexpr std::size_t capacity = 1 << 16;
+
+        unsigned id = 0;
+        std::atomic<const char *> name{nullptr};
+        std::unique_ptr<TraceEvent[]> events = std::make_unique<TraceEvent[]>(capacity);
+        std::atomic<std::uint64_t> begun{0};
+        std::atomic<std::uint64_t> written{0};
+    };
+
+    struct TraceRegistry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<TraceThread>> threads;
+        // Rings whose threads have exited, waiting for the next thread to register.
+        std::vector<TraceThread *> freeRings;
+        std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    };
+
+    TraceRegistry &registry() {
+        static TraceRegistry instance;
+        return instance;
+    }
+
+    std::int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - registry().epoch).count();
+    }
+
+    // Gives a thread's ring back when the thread exits. The ring keeps its events, so a trace still shows
+    // an exited thread until the next thread to take the ring has overwritten them.
+    class RingOwner {
+    public:
+        ~RingOwner() {
+            if (ring) {
+                TraceRegistry &traces = registry();
+                std::lock_guard<std::mutex> lock(traces.mutex);
+                traces.freeRings.push_back(ring);
+            }
+        }
+
+        TraceThread *ring = nullptr;
+    };
+
+    // A thread takes a free ring if there is one, preferring one last used under the same name, so a thread
+    // started for every game, like the logic thread, keeps one timeline. New rings are only made while more
+    // threads are alive than ever before.
+    TraceThread &currentThread(const char *name = nullptr) {
+        thread_local RingOwner owner;
+        if (!owner.ring) {
+            TraceRegistry &traces = registry();
+            std::lock_guard<std::mutex> lock(traces.mutex);
+            auto &freeRings = traces.freeRings;
+            auto reused = std::find_if(freeRings.begin(), freeRings.end(), [name](const TraceThread *ring) {
+                const char *previous = ring->name.load(std::memory_order_relaxed);
+                return name && previous && std::strcmp(name, previous) == 0;
+            });
+            if (reused == freeRings.end() && !freeRings.empty()) {
+                reused = freeRings.begin();
+            }
+            if (reused != freeRings.end()) {
+                owner.ring = *reused;
+                freeRings.erase(reused);
+            } else {
+                auto entry = std::make_unique<TraceThread>();
+                entry->id = static_cast<unsigned>(traces.threads.size()) + 1;
+                owner.ring = entry.get();
+                traces.threads.push_back(std::move(entry));
+            }
+        }
+        return *owner.ring;
+    }
+
+    void record(const char *name, std::int64_t start, std::int64_t duration) {
+        TraceThread &thread = currentThread();
+        std::uint64_t index = thread.written.load(std::memory_order_relaxed);
+        thread.begun.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        TraceEvent &event = thread.events[index % TraceThread::capacity];
+        event.name.store(name, std::memory_order_relaxed);
+        event.start.store(start, std::memory_order_relaxed);
+        event.duration.store(duration, std::memory_order_relaxed);
+        thread.written.store(index + 1, std::memory_order_release);
+    }
+
+    struct CopiedEvent {
+        const char *name;
+        std::int64_t start;
+        std::int64_t duration;
+    };
+
+    // Copies the events still in the ring, oldest first. Returns how many were overwritten and are lost.
+    std::uint64_t copyEvents(const TraceThread &thread, std::vector<CopiedEvent> &out) {
+        std::uint64_t end = thread.written.load(std::memory_order_acquire);
+        std::uint64_t first = end > TraceThread::capacity ? end - TraceThread::capacity : 0;
+        out.clear();
+        out.reserve(end - first);
+        for (std::uint64_t index = first; index < end; ++index) {
+            const TraceEvent &event = thread.events[index % TraceThread::capacity];
+            out.push_back({event.name.load(std::memory_order_relaxed), event.start.load(std::memory_order_relaxed),
+                           event.duration.load(std::memory_order_relaxed)});
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Slots the thread has started rewriting since may hold a mix of two events.
+        std::uint64_t begun = thread.begun.load(std::memory_order_relaxed);
+        std::uint64_t intact = begun > TraceThread::capacity ? begun - TraceThread::capacity : 0;
+        if (intact > first) {
+            std::uint64_t torn = std::min(intact, end) - first;
+            out.erase(out.begin(), out.begin() + static_cast<long>(torn));
+            first += torn;
+        }
+        return first;
+    }
+
+    void writeString(std::ostream &out, const char *text) {
+        out << '"';
+        for (const char *c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') {
+                out << '\\';
+            }
+            out << *c;
+        }
+        out << '"';
+    }
+}
+
+TraceZone::TraceZone(const char *name) : name(name), start(now()) {
+}
+
+TraceZone::~TraceZone() {
+    record(name, start, now() - start);
+}
+
+void traceThreadName(const char *name) {
+    currentThread(name).name.store(name, std::memory_order_release);
+}
+
+bool writeTrace(const std::string &filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open " << filename << " for writing." << std::endl;
+        return false;
+    }
+    TraceRegistry &traces = registry();
+    std::lock_guard<std::mutex> lock(traces.mutex);
+    file << "{\"traceEvents\":[\n";
+    bool first = true;
+    std::uint64_t dropped = 0;
+    std::vector<CopiedEvent> events;
+    for (const auto &thread : traces.threads) {
+        if (const char *name = thread->name.load(std::memory_order_acquire)) {
+            file << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << thread->id
+                 << ",\"args\":{\"name\":";
+            writeString(file, name);
+            file << "}}";
+            first = false;
+        }
+        dropped += copyEvents(*thread, events);
+        for (const CopiedEvent &event : events) {
+            file << (first ? "" : ",\n") << "{\"ph\":\"X\",\"name\":";
+            writeString(file, event.name);
+            file << ",\"pid\":1,\"tid\":" << thread->id << ",\"ts\":" << event.start / 1000 << "." << event.start % 1000 / 100
+                 << ",\"dur\":" << event.duration / 1000 << "." << event.duration % 1000 / 100 << "}";
+            first = false;
+        }
+    }
+    file << "\n]}\n";
+    std::cout << "Trace written to " << filename;
+    if (dropped > 0) {
+        std::cout << " (" << dropped << " older zones were overwritten)";
+    }
+    std::cout << std::endl;
+    return static_cast<bool>(file);
+}
+
+#endif
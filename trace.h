@@ -0,0 +1,43 @@
+#ifndef PROJECT_TRACE_H
+#define PROJECT_TRACE_H
+
+// Scoped-zone tracing. Build with -DMONKEYTYPER_TRACING=ON to record every TRACE_ZONE into per-thread buffers
+// and write them as Chrome trace JSON (chrome://tracing or ui.perfetto.dev). Without it the macros expand to nothing.
+// Each thread keeps only its latest 65536 zones, about 1.5 MiB; older ones are overwritten. Threads that exit
+// leave their buffers to later ones, so memory grows only with the most threads alive at once.
+#ifdef MONKEYTYPER_TRACING
+
+#include <cstdint>
+#include <string>
+
+class TraceZone {
+public:
+    explicit TraceZone(const char *name);
+    ~TraceZone();
+    TraceZone(const TraceZone &) = delete;
+    TraceZone &operator=(const TraceZone &) = delete;
+
+private:
+    const char *name;
+    std::int64_t start;
+};
+
+void traceThreadName(const char *name);
+bool writeTrace(const std::string &filename);
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+// name must be a string literal; only the pointer is stored.
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_THREAD(name) traceThreadName(name)
+#define TRACE_EXPORT(filename) writeTrace(filename)
+
+#else
+
+#define TRACE_ZONE(name) static_cast<void>(0)
+#define TRACE_THREAD(name) static_cast<void>(0)
+#define TRACE_EXPORT(filename) static_cast<void>(0)
+
+#endif
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef PROJECT_TRIPLEBUFFER_H
+#define PROJECT_TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Lock-free hand-off of the latest value from one writer thread to one reader thread.
+// The writer fills back() and publishes it; the reader calls update() and then reads front().
+// Neither side ever waits, and the reader always sees a complete value.
+template <typename T>
+class TripleBuffer {
+public:
+    T &back() {
+        return buffers[backIndex];
+    }
+
+    void publish() {
+        backIndex = middle.exchange(backIndex | dirtyBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & dirtyBit) == 0) {
+            return false;
+        }
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T &front() const {
+        return buffers[frontIndex];
+    }
+
+private:
+    static constexpr unsigned dirtyBit = 4;
+    static constexpr unsigned indexMask = 3;
+
+    T buffers[3];
+    unsigned backIndex = 0;
+    unsigned frontIndex = 1;
+    std::atomic<unsigned> middle{2};
+};
+
+#endif
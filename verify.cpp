@@ -0,0 +1,204 @@
+#include "corpus.h"
+#include "sessionlog.h"
+#include "simulation.h"
+#include "workpool.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace {
+    // Words speed up with every fifteen spawned, so no game lasts anywhere near this long.
+    // Anything claiming more is corrupt, and replaying it would tie up a worker for nothing.
+    constexpr std::uint64_t maxSessionSteps = static_cast<std::uint64_t>(4 * 60 * 60 / Simulation::stepSeconds);
+
+    struct Options {
+        std::string directory;
+        std::string assets = "../assets";
+        unsigned threads = std::thread::hardware_concurrency();
+    };
+
+    enum Verdict { Match, Mismatch, Failed };
+
+    Options parseOptions(int argc, char *argv[]) {
+        Options options;
+        int i = 1;
+        if (argc > 1 && argv[1][0] != '-') {
+            options.directory = argv[1];
+            i = 2;
+        }
+        for (; i + 1 < argc; i += 2) {
+            std::string name = argv[i];
+            std::string value = argv[i + 1];
+            if (name == "--threads") {
+                options.threads = static_cast<unsigned>(std::stoul(value));
+            } else if (name == "--assets") {
+                options.assets = value;
+            } else {
+                std::cerr << "Unknown option " << name << std::endl;
+                std::exit(2);
+            }
+        }
+        if (options.directory.empty()) {
+            options.directory = options.assets + "/sessions";
+        }
+        return options;
+    }
+
+    // Word lists are loaded and measured once per category and font, then shared read-only by every worker.
+    class CorpusCache {
+    public:
+        explicit CorpusCache(std::string assets) : assets(std::move(assets)) {}
+
+        std::shared_ptr<const Corpus> get(const std::string &category, const std::vector<WordIndex::Advance> &advances) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto key = std::make_pair(category, advances);
+            auto found = corpora.find(key);
+            if (found != corpora.end()) {
+                return found->second;
+            }
+            auto corpus = std::make_shared<Corpus>();
+            if (!loadCorpus(assets + "/" + category + ".txt", *corpus) || corpus->words.empty()) {
+                corpus = nullptr;
+            } else {
+                corpus->index.measure(corpus->words, advances);
+            }
+            corpora.emplace(std::move(key), corpus);
+            return corpus;
+        }
+
+    private:
+        std::string assets;
+        std::mutex mutex;
+        std::map<std::pair<std::string, std::vector<WordIndex::Advance>>, std::shared_ptr<const Corpus>> corpora;
+    };
+
+    // Replays the keystrokes as they are read, so memory per worker does not grow with the session length.
+    Verdict verifySession(const std::string &filename, CorpusCache &cache, int &replayedPoints, std::string &detail) {
+        SessionReader reader;
+        if (!reader.open(filename)) {
+            detail = reader.getError();
+            return Failed;
+        }
+        const SessionHeader &header = reader.getHeader();
+        std::shared_ptr<const Corpus> corpus = cache.get(header.category, header.advances);
+        if (!corpus) {
+            detail = "no word list for category " + header.category;
+            return Failed;
+        }
+        if (corpus->hash != header.corpusHash) {
+            detail = "word list for category " + header.category + " has changed";
+            return Failed;
+        }
+
+        Simulation simulation;
+        simulation.setWordSource(corpus, nullptr);
+        simulation.reset(header.config, header.seed);
+        std::uint64_t steps = 0;
+        SessionKey key;
+        while (reader.nextKey(key)) {
+            if (key.step < steps) {
+                detail = "keys out of order";
+                return Failed;
+            }
+            if (key.step > maxSessionSteps) {
+                detail = "key at step " + std::to_string(key.step) + " is past the longest possible game";
+                return Failed;
+            }
+            // A finished game ignores steps, so there is no point running them.
+            for (; steps < key.step && !simulation.isOver(); ++steps) {
+                simulation.step(Simulation::stepSeconds);
+            }
+            steps = key.step;
+            simulation.typeChar(key.key);
+        }
+        if (!reader.isComplete()) {
+            detail = reader.getError();
+            return Failed;
+        }
+        if (reader.getSteps() < steps) {
+            detail = "session ends at step " + std::to_string(reader.getSteps()) + " before its last key at step " + std::to_string(steps);
+            return Failed;
+        }
+        if (reader.getSteps() > maxSessionSteps) {
+            detail = "session of " + std::to_string(reader.getSteps()) + " steps is past the longest possible game";
+            return Failed;
+        }
+        for (; steps < reader.getSteps() && !simulation.isOver(); ++steps) {
+            simulation.step(Simulation::stepSeconds);
+        }
+        replayedPoints = simulation.getPoints();
+        if (replayedPoints != reader.getPoints()) {
+            detail = "claimed " + std::to_string(reader.getPoints()) + ", replayed " + std::to_string(replayedPoints);
+            return Mismatch;
+        }
+        return Match;
+    }
+}
+
+// Usage: monkeytyper_verify [sessions directory] [--threads T] [--assets DIR]
+// Prints one line per session as it finishes and exits with 1 if any claimed score does not replay.
+int main(int argc, char *argv[]) {
+    Options options = parseOptions(argc, argv);
+    std::error_code error;
+    std::filesystem::directory_iterator entries(options.directory, error);
+    if (error) {
+        std::cerr << "Failed to open directory: " << options.directory << std::endl;
+        return 2;
+    }
+
+    WorkPool pool(options.threads);
+    CorpusCache cache(options.assets);
+    std::mutex outputMutex;
+    std::size_t counts[3] = {0, 0, 0};
+
+    // Only a few tasks per worker are queued at once, so a day of sessions never sits in memory.
+    std::mutex slotMutex;
+    std::condition_variable slotFree;
+    std::size_t inFlight = 0;
+    const std::size_t maxInFlight = pool.size() * 4;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &entry : entries) {
+        if (!entry.is_regular_file(error) || entry.path().extension() != ".session") {
+            continue;
+        }
+        {
+            std::unique_lock<std::mutex> lock(slotMutex);
+            slotFree.wait(lock, [&] { return inFlight < maxInFlight; });
+            ++inFlight;
+        }
+        pool.submit([&, path = entry.path().string()](unsigned) {
+            int replayedPoints = 0;
+            std::string detail;
+            Verdict verdict = verifySession(path, cache, replayedPoints, detail);
+            {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                ++counts[verdict];
+                if (verdict == Match) {
+                    std::cout << "OK        " << path << " (" << replayedPoints << ")\n";
+                } else {
+                    std::cout << (verdict == Mismatch ? "MISMATCH  " : "ERROR     ") << path << ": " << detail << "\n";
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(slotMutex);
+                --inFlight;
+            }
+            slotFree.notify_one();
+        });
+    }
+    pool.wait();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "verified " << counts[Match] + counts[Mismatch] + counts[Failed] << " sessions in " << seconds << " s: "
+              << counts[Match] << " ok, " << counts[Mismatch] << " mismatched, " << counts[Failed] << " unreadable" << std::endl;
+    return counts[Mismatch] || counts[Failed] ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+#include "wordindex.h"
+#include "trace.h"
+#include <algorithm>
+
+void WordIndex::build(const std::vector<sf::String> &newWords) {
+    TRACE_ZONE("WordIndex::build");
+    clear();
+    lengths.resize(newWords.size());
+    bucketStart.assign(maxLength + 2, 0);
+    for (std::size_t i = 0; i < newWords.size(); ++i) {
+        lengths[i] = static_cast<std::uint8_t>(std::min<std::size_t>(newWords[i].getSize(), maxLength));
+        ++bucketStart[lengths[i] + 1];
+        for (sf::Uint32 c : newWords[i]) {
+            characters.push_back(c);
+        }
+    }
+    for (std::size_t length = 1; length < bucketStart.size(); ++length) {
+        bucketStart[length] += bucketStart[length - 1];
+    }
+    std::sort(characters.begin(), characters.end());
+    characters.erase(std::unique(characters.begin(), characters.end()), characters.end());
+
+    byLength.resize(newWords.size());
+    std::vector<std::uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (std::size_t i = 0; i < newWords.size(); ++i) {
+        byLength[fill[lengths[i]]++] = static_cast<std::uint32_t>(i);
+    }
+}
+
+void WordIndex::clear() {
+    byLength.clear();
+    bucketStart.clear();
+    lengths.clear();
+    widths.clear();
+    characters.clear();
+    advances.clear();
+}
+
+bool WordIndex::isEmpty() const {
+    return byLength.empty();
+}
+
+bool WordIndex::isMeasured() const {
+    return !widths.empty();
+}
+
+const std::vector<sf::Uint32> &WordIndex::getCharacters() const {
+    return characters;
+}
+
+void WordIndex::measure(const std::vector<sf::String> &words, const std::vector<Advance> &newAdvances) {
+    TRACE_ZONE("WordIndex::measure");
+    if (words.size() != byLength.size()) {
+        return;
+    }
+    advances = newAdvances;
+    std::sort(advances.begin(), advances.end());
+    widths.assign(words.size(), 0.0f);
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        float width = 0;
+        for (sf::Uint32 c : words[i]) {
+            auto advance = std::lower_bound(advances.begin(), advances.end(), Advance(c, 0.0f),
+                                            [](const Advance &a, const Advance &b) { return a.first < b.first; });
+            if (advance != advances.end() && advance->first == c) {
+                width += advance->second;
+            }
+        }
+        widths[i] = width;
+    }
+    sortBuckets();
+}
+
+const std::vector<WordIndex::Advance> &WordIndex::getAdvances() const {
+    return advances;
+}
+
+float WordIndex::getWidth(std::uint32_t wordIndex) const {
+    return wordIndex < widths.size() ? widths[wordIndex] : 0.0f;
+}
+
+// Ties are broken by corpus index so the order, and with it every draw, is the same on every machine.
+void WordIndex::sortBuckets() {
+    for (std::size_t length = 0; length <= maxLength; ++length) {
+        std::sort(byLength.begin() + bucketStart[length], byLength.begin() + bucketStart[length + 1],
+                  [this](std::uint32_t a, std::uint32_t b) {
+                      return widths[a] != widths[b] ? widths[a] < widths[b] : a < b;
+                  });
+    }
+}
+
+std::uint32_t WordIndex::draw(std::uint32_t roll, std::size_t minLength, std::size_t maxLength, float maxWidth) const {
+    if (byLength.empty()) {
+        return 0;
+    }
+    minLength = std::min(minLength, WordIndex::maxLength);
+    maxLength = std::clamp(maxLength, minLength, WordIndex::maxLength);
+
+    // Buckets are narrowest first and words mostly get wider with length, so the fitting range
+    // ends inside the first bucket whose widest word is too wide.
+    auto fitEnd = [this, maxWidth](std::size_t lo, std::size_t hi) {
+        std::uint32_t end = bucketStart[lo];
+        for (std::size_t length = lo; length <= hi; ++length) {
+            auto first = byLength.begin() + bucketStart[length];
+            auto last = byLength.begin() + bucketStart[length + 1];
+            if (first == last) {
+                continue;
+            }
+            if (widths.empty() || widths[*(last - 1)] <= maxWidth) {
+                end = bucketStart[length + 1];
+                continue;
+            }
+            auto fits = std::partition_point(first, last, [this, maxWidth](std::uint32_t word) {
+                return widths[word] <= maxWidth;
+            });
+            end = static_cast<std::uint32_t>(fits - byLength.begin());
+            break;
+        }
+        return end;
+    };
+
+    std::uint32_t begin = bucketStart[minLength];
+    std::uint32_t end = fitEnd(minLength, maxLength);
+    if (end <= begin) {
+        begin = bucketStart[0];
+        end = fitEnd(0, maxLength);
+    }
+    if (end <= begin) {
+        begin = 0;
+        end = static_cast<std::uint32_t>(byLength.size());
+    }
+    return byLength[begin + roll % (end - begin)];
+}
@@ -0,0 +1,44 @@
+#ifndef PROJECT_WORDINDEX_H
+#define PROJECT_WORDINDEX_H
+
+#include <SFML/System/String.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// The corpus grouped into buckets by character count, with every word's pixel width for the current font and size.
+// Words of one length sit next to each other, narrowest first, so a band of lengths that fits a given width is one
+// contiguous range and drawing a word from it is a single lookup.
+class WordIndex {
+public:
+    using Advance = std::pair<sf::Uint32, float>;
+    static constexpr std::size_t maxLength = 32;
+
+    void build(const std::vector<sf::String> &words);
+    void clear();
+    bool isEmpty() const;
+    bool isMeasured() const;
+
+    // Words are measured as the sum of each character's advance, so measuring needs one glyph per distinct character.
+    const std::vector<sf::Uint32> &getCharacters() const;
+    void measure(const std::vector<sf::String> &words, const std::vector<Advance> &newAdvances);
+    const std::vector<Advance> &getAdvances() const;
+    float getWidth(std::uint32_t wordIndex) const;
+
+    // Picks the corpus index of a word with a length in [minLength, maxLength] that is at most maxWidth wide.
+    // Shorter words are used when the band has none that fit. roll chooses the word within the range.
+    std::uint32_t draw(std::uint32_t roll, std::size_t minLength, std::size_t maxLength, float maxWidth) const;
+
+private:
+    void sortBuckets();
+
+    std::vector<std::uint32_t> byLength;
+    std::vector<std::uint32_t> bucketStart;
+    std::vector<std::uint8_t> lengths;
+    std::vector<float> widths;
+    std::vector<sf::Uint32> characters;
+    std::vector<Advance> advances;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "wordstream.h"
+#include "trace.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+    constexpr std::size_t chunkWords = 16;
+}
+
+WordStream::WordStream(std::size_t poolSize) : poolSize(poolSize), rng(std::random_device{}()) {
+    front.reserve(poolSize);
+    back.reserve(poolSize);
+}
+
+WordStream::~WordStream() {
+    close();
+}
+
+bool WordStream::open(const std::string &filename) {
+    close();
+    std::error_code error;
+    fileSize = std::filesystem::file_size(filename, error);
+    if (error || fileSize == 0) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return false;
+    }
+    file.open(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return false;
+    }
+
+    fillPool(front);
+    frontIndex = 0;
+    if (front.empty()) {
+        std::cerr << "No words loaded from file " << filename << std::endl;
+        file.close();
+        return false;
+    }
+    worker = std::thread(&WordStream::run, this);
+    return true;
+}
+
+void WordStream::close() {
+    if (worker.joinable()) {
+        stopping = true;
+        refill.notify_one();
+        worker.join();
+    }
+    if (file.is_open()) {
+        file.close();
+    }
+    front.clear();
+    back.clear();
+    frontIndex = 0;
+    backReady = false;
+    stopping = false;
+}
+
+bool WordStream::isOpen() const {
+    return worker.joinable();
+}
+
+// Never blocks: if the worker has not finished the next pool yet, the current one is reused.
+bool WordStream::next(sf::String &word) {
+    if (frontIndex >= front.size()) {
+        if (backReady.load(std::memory_order_acquire)) {
+            std::swap(front, back);
+            backReady.store(false, std::memory_order_release);
+            refill.notify_one();
+        }
+        frontIndex = 0;
+    }
+    if (front.empty()) {
+        return false;
+    }
+    word = front[frontIndex++];
+    return true;
+}
+
+void WordStream::run() {
+    TRACE_THREAD("words");
+    while (!stopping) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            refill.wait_for(lock, std::chrono::milliseconds(50), [this] {
+                return stopping || !backReady;
+            });
+        }
+        if (!stopping && !backReady.load(std::memory_order_acquire)) {
+            fillPool(back);
+            backReady.store(true, std::memory_order_release);
+        }
+    }
+}
+
+void WordStream::fillPool(std::vector<sf::String> &pool) {
+    TRACE_ZONE("WordStream::fillPool");
+    pool.clear();
+    std::size_t attempts = 0;
+    while (pool.size() < poolSize && attempts++ < poolSize) {
+        readChunk(pool, std::min(chunkWords, poolSize - pool.size()));
+    }
+    std::shuffle(pool.begin(), pool.end(), rng);
+}
+
+// Seeks to a random byte offset, skips the partial word there and reads a run of whole words.
+void WordStream::readChunk(std::vector<sf::String> &pool, std::size_t count) {
+    std::uniform_int_distribution<std::uintmax_t> offsetDist(0, fileSize - 1);
+    std::uintmax_t offset = offsetDist(rng);
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(offset));
+    if (offset > 0) {
+        int c;
+        while ((c = file.get()) != EOF && !std::isspace(c)) {
+        }
+    }
+
+    std::string word;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!(file >> word)) {
+            file.clear();
+            file.seekg(0);
+            if (!(file >> word)) {
+                return;
+            }
+        }
+        pool.push_back(sf::String::fromUtf8(word.begin(), word.end()));
+    }
+}
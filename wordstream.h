@@ -0,0 +1,51 @@
+#ifndef PROJECT_WORDSTREAM_H
+#define PROJECT_WORDSTREAM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <SFML/System/String.hpp>
+
+// Samples words from a word file too large to keep in memory.
+// The game reads from a front pool while a worker thread refills a back pool
+// from random chunks of the file, so memory stays at two pools regardless of file size.
+// Words are decoded from UTF-8 on the worker thread, never on the game thread.
+class WordStream {
+public:
+    explicit WordStream(std::size_t poolSize = 512);
+    ~WordStream();
+
+    bool open(const std::string &filename);
+    void close();
+    bool isOpen() const;
+    bool next(sf::String &word);
+
+    static constexpr std::uintmax_t streamingThreshold = 64ull * 1024 * 1024;
+
+private:
+    void run();
+    void fillPool(std::vector<sf::String> &pool);
+    void readChunk(std::vector<sf::String> &pool, std::size_t count);
+
+    std::size_t poolSize;
+    std::ifstream file;
+    std::uintmax_t fileSize = 0;
+    std::mt19937 rng;
+
+    std::vector<sf::String> front, back;
+    std::size_t frontIndex = 0;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable refill;
+    std::atomic<bool> backReady{false};
+    std::atomic<bool> stopping{false};
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "wordwatcher.h"
+#include "trace.h"
+#include <iostream>
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+WordListWatcher::~WordListWatcher() {
+    stop();
+}
+
+#ifdef __linux__
+
+bool WordListWatcher::start(const std::string &watchedDirectory) {
+    stop();
+    directory = watchedDirectory;
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd < 0 || wakeFd < 0 || inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "Failed to watch " << directory << " for word list changes." << std::endl;
+        stop();
+        return false;
+    }
+    worker = std::thread(&WordListWatcher::run, this);
+    return true;
+}
+
+void WordListWatcher::stop() {
+    if (worker.joinable()) {
+        std::uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) {
+            std::cerr << "Failed to wake the word list watcher." << std::endl;
+        }
+        worker.join();
+    }
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+    if (wakeFd >= 0) {
+        close(wakeFd);
+        wakeFd = -1;
+    }
+}
+
+void WordListWatcher::run() {
+    TRACE_THREAD("watcher");
+    pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+        // Editors often write a file in several steps, so a burst of events causes one reload.
+        bool changed = false;
+        std::string watched;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            watched = file;
+        }
+        ssize_t length;
+        while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char *cursor = buffer; cursor < buffer + length;) {
+                auto *event = reinterpret_cast<inotify_event *>(cursor);
+                if (event->len > 0 && !watched.empty() && watched == event->name) {
+                    changed = true;
+                }
+                cursor += sizeof(inotify_event) + event->len;
+            }
+        }
+        if (changed) {
+            reload(watched);
+        }
+    }
+}
+
+#else
+
+bool WordListWatcher::start(const std::string &watchedDirectory) {
+    directory = watchedDirectory;
+    return false;
+}
+
+void WordListWatcher::stop() {
+}
+
+void WordListWatcher::run() {
+}
+
+#endif
+
+void WordListWatcher::setFile(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    file = name;
+}
+
+void WordListWatcher::discardReloaded() {
+    std::lock_guard<std::mutex> lock(mutex);
+    reloadReady.store(false, std::memory_order_relaxed);
+    reloaded.reset();
+}
+
+void WordListWatcher::setAdvances(std::vector<WordIndex::Advance> newAdvances) {
+    std::lock_guard<std::mutex> lock(mutex);
+    advances = std::move(newAdvances);
+}
+
+void WordListWatcher::reload(const std::string &name) {
+    TRACE_ZONE("WordListWatcher::reload");
+    auto corpus = std::make_shared<Corpus>();
+    if (!loadCorpus(directory + "/" + name, *corpus) || corpus->words.empty()) {
+        std::cerr << "Ignoring empty or unreadable word list " << name << std::endl;
+        return;
+    }
+    std::vector<WordIndex::Advance> measuredAdvances;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        measuredAdvances = advances;
+    }
+    if (!measuredAdvances.empty()) {
+        corpus->index.measure(corpus->words, measuredAdvances);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    reloaded = std::move(corpus);
+    reloadedFile = name;
+    reloadReady.store(true, std::memory_order_release);
+}
+
+std::shared_ptr<Corpus> WordListWatcher::takeReloaded(std::string &name) {
+    if (!reloadReady.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    reloadReady.store(false, std::memory_order_relaxed);
+    name = reloadedFile;
+    return std::move(reloaded);
+}
@@ -0,0 +1,47 @@
+#ifndef PROJECT_WORDWATCHER_H
+#define PROJECT_WORDWATCHER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "corpus.h"
+
+// Watches the word list directory and reparses a word file on its own thread whenever it is rewritten,
+// so a changed list can be swapped in without a restart. Uses inotify, so it only watches on Linux.
+class WordListWatcher {
+public:
+    ~WordListWatcher();
+
+    bool start(const std::string &watchedDirectory);
+    void stop();
+    // The file inside the directory to reload, or an empty name to ignore every change.
+    void setFile(const std::string &name);
+    // Glyph advances of the font in use. Reloads are measured with them on the watcher thread,
+    // so adopting one costs the render thread no measuring.
+    void setAdvances(std::vector<WordIndex::Advance> advances);
+    // Hands over the most recent reload since the last call, or nothing. Never waits for parsing.
+    std::shared_ptr<Corpus> takeReloaded(std::string &name);
+    // Drops a reload nobody has taken yet, e.g. one that is older than a word list just loaded from disk.
+    void discardReloaded();
+
+private:
+    void run();
+    void reload(const std::string &name);
+
+    std::string directory;
+    std::thread worker;
+    int inotifyFd = -1;
+    int wakeFd = -1;
+
+    std::mutex mutex;
+    std::string file;
+    std::vector<WordIndex::Advance> advances;
+    std::shared_ptr<Corpus> reloaded;
+    std::string reloadedFile;
+    std::atomic<bool> reloadReady{false};
+};
+
+#endif
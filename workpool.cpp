@@ -0,0 +1,84 @@
+#include "workpool.h"
+#include <chrono>
+
+WorkPool::WorkPool(unsigned threads) {
+    threads = std::max(threads, 1u);
+    for (unsigned i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&WorkPool::run, this, i);
+    }
+}
+
+WorkPool::~WorkPool() {
+    wait();
+    stopping = true;
+    workAvailable.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned WorkPool::size() const {
+    return static_cast<unsigned>(workers.size());
+}
+
+void WorkPool::submit(Task task) {
+    Queue &queue = *queues[nextQueue++ % queues.size()];
+    ++pending;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    ++queued;
+    workAvailable.notify_one();
+}
+
+void WorkPool::wait() {
+    std::unique_lock<std::mutex> lock(idleMutex);
+    allDone.wait(lock, [this] { return pending == 0; });
+}
+
+bool WorkPool::takeTask(unsigned worker, Task &task) {
+    {
+        Queue &own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --queued;
+            return true;
+        }
+    }
+    for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+        Queue &victim = *queues[(worker + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkPool::run(unsigned worker) {
+    Task task;
+    while (!stopping) {
+        if (takeTask(worker, task)) {
+            task(worker);
+            task = nullptr;
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(idleMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(idleMutex);
+        workAvailable.wait_for(lock, std::chrono::milliseconds(10), [this] {
+            return stopping || queued > 0;
+        });
+    }
+}
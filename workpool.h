@@ -0,0 +1,48 @@
+#ifndef PROJECT_WORKPOOL_H
+#define PROJECT_WORKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool with one task deque per worker.
+// A worker takes its newest task first and, when its own deque is empty, steals the oldest task of another worker.
+// Tasks receive the index of the worker running them, so callers can keep per-worker state without locking.
+class WorkPool {
+public:
+    using Task = std::function<void(unsigned worker)>;
+
+    explicit WorkPool(unsigned threads = std::thread::hardware_concurrency());
+    ~WorkPool();
+
+    void submit(Task task);
+    void wait();
+    unsigned size() const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(unsigned worker);
+    bool takeTask(unsigned worker, Task &task);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<unsigned> nextQueue{0};
+    std::atomic<std::size_t> pending{0};
+    std::atomic<std::size_t> queued{0};
+    std::atomic<bool> stopping{false};
+    std::mutex idleMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+};
+
+#endif